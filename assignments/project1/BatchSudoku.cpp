@@ -0,0 +1,340 @@
+#ifndef _BATCHSUDOKU_CPP
+#define _BATCHSUDOKU_CPP
+
+//BatchSudoku.cpp
+#include "BatchSudoku.hpp"
+#include <cassert>
+#include <cstring>
+#include <thread>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const uint16_t ALL_DIGITS = 0x1FF;
+const int CELLS = 81;
+const int PADDED = 96; // room for a full-width vector load past the end
+
+// units[u] lists the squares of row u (u<9), column u-9 (u<18),
+// or zone u-18.  peers[s] lists the 20 squares sharing a unit with s.
+int units[27][9];
+int peers[CELLS][20];
+
+struct tables {
+  tables() {
+    for (int k=0; k<9; k++) {
+      for (int m=0; m<9; m++) {
+        units[k][m] = k*9 + m;
+        units[9+k][m] = m*9 + k;
+        units[18+k][m] = ((k/3)*3 + m/3)*9 + (k%3)*3 + m%3;
+      }
+    }
+    for (int s=0; s<CELLS; s++) {
+      int n = 0;
+      for (int t=0; t<CELLS; t++) {
+        if (t==s) continue;
+        if (t/9==s/9 || t%9==s%9 ||
+            ((t/27==s/27) && ((t%9)/3==(s%9)/3))) peers[s][n++] = t;
+      }
+      assert(n==20);
+    }
+  }
+};
+tables buildTables;
+
+// One grid.  A square is "open" until its digit has been placed and
+// removed from all its peers; after that its candidate mask holds just
+// that digit.  Padding squares have no candidates and are never open.
+struct board {
+  uint16_t cand[PADDED];
+  uint16_t open[PADDED]; // 0xFFFF for open squares, 0 otherwise
+  int remaining;         // how many squares still open
+};
+
+inline int lowDigit(uint16_t mask) { return __builtin_ctz(mask); }
+
+// Places the single candidate in square s and removes it from the peers.
+inline bool place(board &b, int s) {
+  uint16_t bit = b.cand[s];
+  if (bit==0) return false; // A peer took our last candidate.
+  b.open[s] = 0;
+  b.remaining--;
+  for (int k=0; k<20; k++) {
+    int p = peers[s][k];
+    if (b.cand[p] & bit) {
+      if (!b.open[p]) return false; // Same digit already placed nearby.
+      b.cand[p] &= (uint16_t)~bit;
+    }
+  }
+  return true;
+}
+
+// Finds open squares with zero or one candidate.  Sets 'singles' (one
+// bit per square) and returns false if some open square has none.
+inline bool scanSingles(const board &b, uint64_t singles[2]) {
+  singles[0] = singles[1] = 0;
+#if defined(__AVX2__)
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi16(1);
+  for (int base=0; base<CELLS; base+=16) {
+    __m256i c = _mm256_loadu_si256((const __m256i *)(b.cand + base));
+    __m256i o = _mm256_loadu_si256((const __m256i *)(b.open + base));
+    __m256i empty = _mm256_and_si256(_mm256_cmpeq_epi16(c, zero), o);
+    if (!_mm256_testz_si256(empty, empty)) return false;
+    __m256i low = _mm256_and_si256(c, _mm256_sub_epi16(c, one));
+    __m256i single = _mm256_and_si256(_mm256_cmpeq_epi16(low, zero), o);
+    // movemask gives two bits per 16-bit lane; keep the even ones.
+    uint32_t m = (uint32_t)_mm256_movemask_epi8(single) & 0x55555555u;
+    for (; m; m &= m-1) {
+      int s = base + __builtin_ctz(m)/2;
+      singles[s>>6] |= (uint64_t)1 << (s&63);
+    }
+  }
+#elif defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i one = _mm_set1_epi16(1);
+  for (int base=0; base<CELLS; base+=8) {
+    __m128i c = _mm_loadu_si128((const __m128i *)(b.cand + base));
+    __m128i o = _mm_loadu_si128((const __m128i *)(b.open + base));
+    __m128i empty = _mm_and_si128(_mm_cmpeq_epi16(c, zero), o);
+    if (_mm_movemask_epi8(empty)) return false;
+    __m128i low = _mm_and_si128(c, _mm_sub_epi16(c, one));
+    __m128i single = _mm_and_si128(_mm_cmpeq_epi16(low, zero), o);
+    // Pack the 16-bit lanes down to bytes, one movemask bit per square.
+    uint32_t m = (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(single, zero));
+    for (; m; m &= m-1) {
+      int s = base + __builtin_ctz(m);
+      singles[s>>6] |= (uint64_t)1 << (s&63);
+    }
+  }
+#else
+  for (int s=0; s<CELLS; s++) {
+    if (!b.open[s]) continue;
+    uint16_t c = b.cand[s];
+    if (c==0) return false;
+    if ((c & (c-1))==0) singles[s>>6] |= (uint64_t)1 << (s&63);
+  }
+#endif
+  return true;
+}
+
+// Hidden singles in one unit:  digits that fit exactly one open square
+// there get that square narrowed down to them.
+inline bool hiddenInUnit(board &b, const int *unit, bool &changed) {
+  uint16_t once = 0, twice = 0, placed = 0;
+  for (int m=0; m<9; m++) {
+    uint16_t c = b.cand[unit[m]];
+    if (b.open[unit[m]]) { twice |= once & c; once |= c; }
+    else placed |= c;
+  }
+  if ((once | placed)!=ALL_DIGITS) return false; // A digit has nowhere to go.
+  uint16_t hidden = once & (uint16_t)~twice & (uint16_t)~placed;
+  for (int m=0; m<9 && hidden; m++) {
+    int s = unit[m];
+    uint16_t h = b.cand[s] & hidden;
+    if (!b.open[s] || !h) continue;
+    if (h & (h-1)) return false; // Two digits both need this square.
+    if (b.cand[s]!=h) { b.cand[s] = h; changed = true; }
+    hidden &= (uint16_t)~h;
+  }
+  return true;
+}
+
+// The columns all at once:  row r's squares are at cand[r*9 .. r*9+8],
+// so a vector load from each row start lines up one column per lane.
+inline bool hiddenInColumns(board &b, bool &changed) {
+#if defined(__AVX2__) || defined(__SSE2__)
+#if defined(__AVX2__)
+  const int LANES = 9;
+#else
+  const int LANES = 8;
+#endif
+  uint16_t onceOut[16], twiceOut[16], placedOut[16];
+#if defined(__AVX2__)
+  __m256i once = _mm256_setzero_si256(), twice = once, placed = once;
+  for (int r=0; r<9; r++) {
+    __m256i c = _mm256_loadu_si256((const __m256i *)(b.cand + r*9));
+    __m256i o = _mm256_loadu_si256((const __m256i *)(b.open + r*9));
+    __m256i oc = _mm256_and_si256(c, o);
+    twice = _mm256_or_si256(twice, _mm256_and_si256(once, oc));
+    once = _mm256_or_si256(once, oc);
+    placed = _mm256_or_si256(placed, _mm256_andnot_si256(o, c));
+  }
+  _mm256_storeu_si256((__m256i *)onceOut, once);
+  _mm256_storeu_si256((__m256i *)twiceOut, twice);
+  _mm256_storeu_si256((__m256i *)placedOut, placed);
+#else
+  __m128i once = _mm_setzero_si128(), twice = once, placed = once;
+  for (int r=0; r<9; r++) {
+    __m128i c = _mm_loadu_si128((const __m128i *)(b.cand + r*9));
+    __m128i o = _mm_loadu_si128((const __m128i *)(b.open + r*9));
+    __m128i oc = _mm_and_si128(c, o);
+    twice = _mm_or_si128(twice, _mm_and_si128(once, oc));
+    once = _mm_or_si128(once, oc);
+    placed = _mm_or_si128(placed, _mm_andnot_si128(o, c));
+  }
+  _mm_storeu_si128((__m128i *)onceOut, once);
+  _mm_storeu_si128((__m128i *)twiceOut, twice);
+  _mm_storeu_si128((__m128i *)placedOut, placed);
+#endif
+  for (int col=0; col<LANES; col++) {
+    if ((onceOut[col] | placedOut[col])!=ALL_DIGITS) return false;
+    uint16_t hidden = onceOut[col] & (uint16_t)~twiceOut[col] &
+      (uint16_t)~placedOut[col];
+    for (int r=0; r<9 && hidden; r++) {
+      int s = r*9 + col;
+      uint16_t h = b.cand[s] & hidden;
+      if (!b.open[s] || !h) continue;
+      if (h & (h-1)) return false;
+      if (b.cand[s]!=h) { b.cand[s] = h; changed = true; }
+      hidden &= (uint16_t)~h;
+    }
+  }
+  for (int col=LANES; col<9; col++) {
+    if (!hiddenInUnit(b, units[9+col], changed)) return false;
+  }
+  return true;
+#else
+  for (int col=0; col<9; col++) {
+    if (!hiddenInUnit(b, units[9+col], changed)) return false;
+  }
+  return true;
+#endif
+}
+
+// Naked and hidden singles until nothing changes.  Returns false on a
+// contradiction.
+bool propagate(board &b) {
+  bool changed = true;
+  while (changed && b.remaining>0) {
+    changed = false;
+    uint64_t singles[2];
+    if (!scanSingles(b, singles)) return false;
+    for (int w=0; w<2; w++) {
+      for (uint64_t m=singles[w]; m; m &= m-1) {
+        if (!place(b, w*64 + __builtin_ctzll(m))) return false;
+        changed = true;
+      }
+    }
+    if (changed) continue; // Cheap deductions first.
+
+    for (int u=0; u<9; u++) {
+      if (!hiddenInUnit(b, units[u], changed)) return false;
+    }
+    if (!hiddenInColumns(b, changed)) return false;
+    for (int u=18; u<27; u++) {
+      if (!hiddenInUnit(b, units[u], changed)) return false;
+    }
+  }
+  return true;
+}
+
+bool search(board &b) {
+  if (!propagate(b)) return false;
+  if (b.remaining==0) return true;
+
+  // Branch on the open square with the fewest candidates.
+  int best = -1;
+  int fewest = 10;
+  for (int s=0; s<CELLS && fewest>2; s++) {
+    if (!b.open[s]) continue;
+    int count = __builtin_popcount(b.cand[s]);
+    if (count<fewest) { fewest = count; best = s; }
+  }
+
+  for (uint16_t m=b.cand[best]; m; m &= (uint16_t)(m-1)) {
+    board next = b;
+    next.cand[best] = m & (uint16_t)-m;
+    if (search(next)) { b = next; return true; }
+  }
+  return false;
+}
+
+}
+
+BatchSudoku::BatchSudoku(int t) {
+  threads = t;
+  if (threads<=0) threads = (int)thread::hardware_concurrency();
+  if (threads<=0) threads = 1;
+}
+
+BatchSudoku::~BatchSudoku() { }
+
+BatchSudoku::result BatchSudoku::solveOne(const char *puzzle, int length, char *out) {
+  // Tolerate a trailing carriage return from DOS line endings.
+  if (length==CELLS+1 && puzzle[CELLS]=='\r') length = CELLS;
+  if (length!=CELLS) return INVALID;
+
+  board b;
+  memset(&b, 0, sizeof(b));
+  b.remaining = CELLS;
+  for (int s=0; s<CELLS; s++) {
+    char ch = puzzle[s];
+    b.open[s] = 0xFFFF;
+    if (ch=='0' || ch=='.') b.cand[s] = ALL_DIGITS;
+    else if (ch>='1' && ch<='9') b.cand[s] = (uint16_t)(1 << (ch-'1'));
+    else return INVALID;
+  }
+
+  if (!search(b)) return UNSOLVABLE;
+  for (int s=0; s<CELLS; s++) out[s] = (char)('1' + lowDigit(b.cand[s]));
+  return SOLVED;
+}
+
+void BatchSudoku::solveBatch(const vector<string> &puzzles, vector<string> &answers) {
+  int n = (int)puzzles.size();
+  answers.assign(n, string());
+
+  // Thread k takes puzzles k, k+threads, k+2*threads, ... so hard
+  // puzzles clustered in the input don't all land on one thread.
+  struct worker {
+    static void run(const vector<string> *in, vector<string> *out, int first, int step) {
+      char grid[CELLS];
+      for (int i=first; i<(int)in->size(); i+=step) {
+        const string &p = (*in)[i];
+        switch (solveOne(p.data(), (int)p.length(), grid)) {
+        case SOLVED: (*out)[i].assign(grid, CELLS); break;
+        case UNSOLVABLE: (*out)[i] = "unsolvable"; break;
+        case INVALID: (*out)[i] = "invalid"; break;
+        }
+      }
+    }
+  };
+
+  int used = (n<threads) ? n : threads;
+  if (used<=1) {
+    worker::run(&puzzles, &answers, 0, 1);
+    return;
+  }
+  vector<thread> pool;
+  for (int k=1; k<used; k++) {
+    pool.push_back(thread(worker::run, &puzzles, &answers, k, used));
+  }
+  worker::run(&puzzles, &answers, 0, used);
+  for (int k=0; k<(int)pool.size(); k++) pool[k].join();
+}
+
+long BatchSudoku::solveStream(istream &in, ostream &out) {
+  long total = 0;
+  vector<string> puzzles;
+  vector<string> answers;
+  string line;
+  while (in) {
+    puzzles.clear();
+    while ((int)puzzles.size()<BLOCK_SIZE && getline(in, line)) {
+      puzzles.push_back(line);
+    }
+    if (puzzles.empty()) break;
+    solveBatch(puzzles, answers);
+    for (int i=0; i<(int)answers.size(); i++) out << answers[i] << '\n';
+    total += (long)puzzles.size();
+  }
+  out.flush();
+  return total;
+}
+
+#endif
@@ -0,0 +1,52 @@
+//BatchSudoku.hpp
+#ifndef _BATCHSUDOKU_HPP
+#define _BATCHSUDOKU_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+using namespace std;
+
+/*
+  BatchSudoku.hpp
+
+  A high-throughput 9x9 Sudoku solver for large files of puzzles.
+  Unlike Sudoku, there is no PuzzleState per move:  each grid is one
+  flat array of candidate bitmasks (bit d-1 set iff digit d could still
+  go in that square), propagated with naked and hidden singles and
+  searched depth-first on the square with the fewest candidates.
+
+  The propagation steps use SSE2 (or AVX2, if compiled with -mavx2)
+  to test eight (sixteen) squares at once, with a plain C++ fallback
+  on other machines.  Batches are split over several threads.
+*/
+
+class BatchSudoku {
+ public:
+  // threads==0 means one thread per core.
+  BatchSudoku(int threads = 0);
+  ~BatchSudoku();
+
+  // Solves one puzzle:  81 characters in row-major order, '0' or '.'
+  // for blanks.  On success, writes the 81 digit solution to out and
+  // returns SOLVED.  out is left alone otherwise.
+  enum result { SOLVED, UNSOLVABLE, INVALID };
+  static result solveOne(const char *puzzle, int length, char *out);
+
+  // Solves every puzzle in puzzles, putting one line per puzzle in
+  // answers:  the solution, or "unsolvable"/"invalid".
+  void solveBatch(const vector<string> &puzzles, vector<string> &answers);
+
+  // Reads puzzles from in, one per line, and streams answers to out
+  // in the same order, a block at a time.  Returns how many were read.
+  long solveStream(istream &in, ostream &out);
+
+  int getThreads() { return threads; }
+
+ private:
+  int threads;
+  const static int BLOCK_SIZE = 16384; // puzzles read per batch
+};
+
+#endif
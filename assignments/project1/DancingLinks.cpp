@@ -0,0 +1,168 @@
+#ifndef _DANCINGLINKS_CPP
+#define _DANCINGLINKS_CPP
+
+//DancingLinks.cpp
+#include "DancingLinks.hpp"
+#include <cassert>
+#include <cstdlib>//for NULL
+
+// Placement r = (row*9 + col)*9 + digit-1 covers columns:
+//   1 + row*9+col                      square (row,col) is filled
+//   1 + 81  + row*9+digit-1            row has the digit
+//   1 + 162 + col*9+digit-1            column has the digit
+//   1 + 243 + zone*9+digit-1           zone has the digit
+
+DancingLinks::DancingLinks() {
+  nodes = new node[MAX_NODES];
+
+  // Column headers in a circular list through the root.
+  for (int c=0; c<=COLUMNS; c++) {
+    nodes[c].left = (c==0) ? COLUMNS : c-1;
+    nodes[c].right = (c==COLUMNS) ? 0 : c+1;
+    nodes[c].up = c;
+    nodes[c].down = c;
+    nodes[c].column = c;
+    nodes[c].row = -1;
+    size[c] = 0;
+  }
+
+  int next = COLUMNS+1;
+  for (int r=0; r<ROWS; r++) {
+    int square = r/9;
+    int digit = r%9;
+    int row = square/9;
+    int col = square%9;
+    int zone = (row/3)*3 + col/3;
+    int cols[4] = { 1 + square, 1 + 81 + row*9 + digit,
+                    1 + 162 + col*9 + digit, 1 + 243 + zone*9 + digit };
+    rowStart[r] = next;
+    for (int k=0; k<4; k++) {
+      int n = next + k;
+      int c = cols[k];
+      // Circular row list of four nodes
+      nodes[n].left = next + (k+3)%4;
+      nodes[n].right = next + (k+1)%4;
+      // Append to the bottom of column c
+      nodes[n].up = nodes[c].up;
+      nodes[n].down = c;
+      nodes[nodes[c].up].down = n;
+      nodes[c].up = n;
+      nodes[n].column = c;
+      nodes[n].row = r;
+      size[c]++;
+    }
+    next += 4;
+  }
+  assert(next==MAX_NODES);
+  depth = 0;
+  nodeCount = 0;
+}
+
+DancingLinks::~DancingLinks() { delete [] nodes; }
+
+void DancingLinks::cover(int c) {
+  nodes[nodes[c].right].left = nodes[c].left;
+  nodes[nodes[c].left].right = nodes[c].right;
+  for (int i=nodes[c].down; i!=c; i=nodes[i].down) {
+    for (int j=nodes[i].right; j!=i; j=nodes[j].right) {
+      nodes[nodes[j].down].up = nodes[j].up;
+      nodes[nodes[j].up].down = nodes[j].down;
+      size[nodes[j].column]--;
+    }
+  }
+}
+
+void DancingLinks::uncover(int c) {
+  // Exactly the reverse of cover(), so the links "dance" back in place.
+  for (int i=nodes[c].up; i!=c; i=nodes[i].up) {
+    for (int j=nodes[i].left; j!=i; j=nodes[j].left) {
+      size[nodes[j].column]++;
+      nodes[nodes[j].down].up = j;
+      nodes[nodes[j].up].down = j;
+    }
+  }
+  nodes[nodes[c].right].left = c;
+  nodes[nodes[c].left].right = c;
+}
+
+bool DancingLinks::search() {
+  if (nodes[ROOT].right==ROOT) return true; // Everything covered!
+  nodeCount++;
+
+  // Branch on the column with the fewest remaining choices.
+  int c = nodes[ROOT].right;
+  for (int j=nodes[c].right; j!=ROOT && size[c]>1; j=nodes[j].right) {
+    if (size[j]<size[c]) c = j;
+  }
+  if (size[c]==0) return false;
+
+  cover(c);
+  for (int r=nodes[c].down; r!=c; r=nodes[r].down) {
+    chosen[depth++] = nodes[r].row;
+    for (int j=nodes[r].right; j!=r; j=nodes[j].right) cover(nodes[j].column);
+    bool found = search();
+    for (int j=nodes[r].left; j!=r; j=nodes[j].left) uncover(nodes[j].column);
+    if (found) {
+      uncover(c);
+      return true;
+    }
+    depth--;
+  }
+  uncover(c);
+  return false;
+}
+
+bool DancingLinks::place(int row) {
+  // A given is legal only if none of its columns is already covered.
+  int start = rowStart[row];
+  int n = start;
+  do {
+    int c = nodes[n].column;
+    if (nodes[nodes[c].left].right!=c) return false;
+    n = nodes[n].right;
+  } while (n!=start);
+  n = start;
+  do {
+    cover(nodes[n].column);
+    n = nodes[n].right;
+  } while (n!=start);
+  chosen[depth++] = row;
+  return true;
+}
+
+bool DancingLinks::solve(string config, string &solution) {
+  depth = 0;
+  nodeCount = 0;
+
+  int givens = 0;
+  bool ok = (config.length()>=81);
+  for (int i=0; ok && i<81; i++) {
+    if (config[i]=='0') continue;
+    if (config[i]<'1' || config[i]>'9') { ok = false; break; }
+    if (!place(i*9 + config[i]-'1')) { ok = false; break; }
+    givens++;
+  }
+  if (ok) ok = search();
+
+  if (ok) {
+    solution = string(81,'0');
+    for (int i=0; i<depth; i++) {
+      solution[chosen[i]/9] = (char)('1' + chosen[i]%9);
+    }
+  }
+
+  // Put the givens' columns back, most recent first, so the matrix
+  // is ready for the next puzzle.  (search() restores its own.)
+  for (int i=givens-1; i>=0; i--) {
+    int start = rowStart[chosen[i]];
+    int n = nodes[start].left;
+    do {
+      uncover(nodes[n].column);
+      n = nodes[n].left;
+    } while (n!=nodes[start].left);
+  }
+  depth = 0;
+  return ok;
+}
+
+#endif
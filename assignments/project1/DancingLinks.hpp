@@ -0,0 +1,63 @@
+//DancingLinks.hpp
+#ifndef _DANCINGLINKS_HPP
+#define _DANCINGLINKS_HPP
+
+#include <string>
+using namespace std;
+
+/*
+  DancingLinks.hpp
+
+  A dedicated Sudoku solver, using Knuth's Algorithm X with dancing
+  links.  Sudoku is treated as an exact cover problem:  each of the
+  729 (row, column, digit) placements covers four constraints (the
+  square is filled, and the digit appears once in the row, column and
+  zone), and a solution is a set of placements covering each of the
+  324 constraints exactly once.
+
+  This skips the generic PuzzleState/PredDict search entirely, so it
+  can't print the sequence of moves -- only the finished grid.
+*/
+
+class DancingLinks {
+ public:
+  DancingLinks();
+  ~DancingLinks();
+
+  // Takes the same 81 character string as the Sudoku constructor
+  // (row-major order, '0' for blanks).  Returns true iff the grid has
+  // a solution, in which case solution is set to the filled-in grid
+  // in the same format.
+  bool solve(string config, string &solution);
+
+  // How many times search() chose a column on the last solve.
+  int getNodeCount() { return nodeCount; }
+
+ private:
+  const static int COLUMNS = 324;    // constraints
+  const static int ROWS = 729;       // possible placements
+  const static int ROOT = 0;         // header of the column list
+  const static int MAX_NODES = 1 + COLUMNS + 4*ROWS;
+
+  // All nodes live in one preallocated array, linked by index.
+  // Nodes 1..COLUMNS are the column headers.
+  struct node {
+    int left, right, up, down;
+    int column; // header of this node's column
+    int row;    // placement this node belongs to (-1 for headers)
+  };
+  node *nodes;
+  int size[COLUMNS+1]; // number of nodes still in each column
+  int rowStart[ROWS];  // first node of each placement's row
+
+  int chosen[81];      // placements picked so far
+  int depth;           // how many placements in chosen
+  int nodeCount;
+
+  void cover(int c);
+  void uncover(int c);
+  bool search();
+  bool place(int row); // Covers a given's columns; false if it clashes.
+};
+
+#endif
@@ -0,0 +1,200 @@
+#include <iostream>
+#include <queue>
+#include <cstdlib>
+using namespace std;
+
+#include "GridPathFinder.hpp"
+
+GridPathFinder::GridPathFinder(MazeGrid *g) : grid(g) {
+  grid->retain();
+  rows = grid->getRows();
+  cols = grid->getCols();
+  expanded = 0;
+}
+
+GridPathFinder::~GridPathFinder() { grid->release(); }
+
+void GridPathFinder::reset(int bitsPerSquare) {
+  long squares = (long)rows*cols;
+  visited.assign((squares*bitsPerSquare + 63)/64, 0);
+  parent.assign(squares, -1);
+  dist.assign(squares, -1);
+  expanded = 0;
+}
+
+int GridPathFinder::heuristic(int square) {
+  // Manhattan distance to the nearest target never overestimates with
+  // 4-way moves, and the distance field (if built) is exact.
+  if (grid->getTargetCount()==0) return 0;
+  return grid->targetDistance(square/cols, square%cols);
+}
+
+bool GridPathFinder::findPath(int row, int col, method how, vector<int> &path) {
+  path.clear();
+  if (!open(row, col)) return false;
+
+  int start = row*cols + col;
+  int goal = -1;
+  bool found;
+  if (how==BFS) found = bfs(start, goal);
+  else if (how==ASTAR) found = astar(start, goal);
+  else found = jps(start, goal);
+  if (!found) return false;
+
+  // Walk the parents back from the goal.  For JPS consecutive squares
+  // on that walk are jump points in a straight line, so fill in between.
+  for (int s=goal; s!=-1; s=parent[s]) {
+    path.push_back(s);
+    int p = parent[s];
+    if (p==-1) break;
+    int step = (p/cols==s/cols) ? ((p>s) ? 1 : -1) : ((p>s) ? cols : -cols);
+    for (int t=s+step; t!=p; t+=step) path.push_back(t);
+  }
+  for (int i=0, j=(int)path.size()-1; i<j; i++, j--) {
+    int t = path[i]; path[i] = path[j]; path[j] = t;
+  }
+  return true;
+}
+
+bool GridPathFinder::bfs(int start, int &goal) {
+  reset(1);
+  vector<int> queue;
+  queue.reserve(1024);
+  queue.push_back(start);
+  setVisited(start);
+  const int dr[4] = {1,-1,0,0};
+  const int dc[4] = {0,0,1,-1};
+  for (size_t head=0; head<queue.size(); head++) {
+    int s = queue[head];
+    int r = s/cols, c = s%cols;
+    if (grid->isTarget(r, c)) { goal = s; return true; }
+    expanded++;
+    for (int k=0; k<4; k++) {
+      if (!open(r+dr[k], c+dc[k])) continue;
+      int t = s + dr[k]*cols + dc[k];
+      if (testVisited(t)) continue;
+      setVisited(t);
+      parent[t] = s;
+      queue.push_back(t);
+    }
+  }
+  return false;
+}
+
+bool GridPathFinder::astar(int start, int &goal) {
+  reset(1);
+  priority_queue<entry> heap;
+  entry e = { heuristic(start), 0, start, 0 };
+  dist[start] = 0;
+  heap.push(e);
+  const int dr[4] = {1,-1,0,0};
+  const int dc[4] = {0,0,1,-1};
+  while (!heap.empty()) {
+    e = heap.top();
+    heap.pop();
+    if (testVisited(e.square)) continue; // Stale entry.
+    setVisited(e.square);
+    int r = e.square/cols, c = e.square%cols;
+    if (grid->isTarget(r, c)) { goal = e.square; return true; }
+    expanded++;
+    for (int k=0; k<4; k++) {
+      if (!open(r+dr[k], c+dc[k])) continue;
+      int t = e.square + dr[k]*cols + dc[k];
+      if (testVisited(t)) continue;
+      if (dist[t]!=-1 && dist[t]<=e.g+1) continue;
+      dist[t] = e.g+1;
+      parent[t] = e.square;
+      entry next = { e.g+1+heuristic(t), e.g+1, t, 0 };
+      heap.push(next);
+    }
+  }
+  return false;
+}
+
+// Jump Point Search on a 4-way grid.
+//
+// Every shortest path can be rearranged so that, while moving
+// horizontally, it only turns up (down) at a square whose up (down)
+// neighbour could not have been reached from the square before it --
+// otherwise turning one square earlier is just as short.  Vertical runs
+// may turn at any square.  So:
+//  - a horizontal jump slides until the target, a wall, or a square
+//    with such a "forced" vertical turn;
+//  - a vertical jump slides until the target, a wall, or a square from
+//    which a horizontal jump finds something.
+// A* then runs over the squares where jumps stop.
+
+int GridPathFinder::jumpHorizontal(int row, int col, int dc) {
+  while (true) {
+    col += dc;
+    if (!open(row, col)) return -1;
+    if (grid->isTarget(row, col)) return row*cols + col;
+    if ((open(row-1, col) && !open(row-1, col-dc)) ||
+        (open(row+1, col) && !open(row+1, col-dc))) return row*cols + col;
+  }
+}
+
+int GridPathFinder::jumpVertical(int row, int col, int dr) {
+  while (true) {
+    row += dr;
+    if (!open(row, col)) return -1;
+    if (grid->isTarget(row, col)) return row*cols + col;
+    if (jumpHorizontal(row, col, 1)!=-1 ||
+        jumpHorizontal(row, col, -1)!=-1) return row*cols + col;
+  }
+}
+
+bool GridPathFinder::jps(int start, int &goal) {
+  // A square may be reached moving in any of four directions, and what
+  // it goes on to explore depends on that, so there is one visited bit
+  // per (square, direction):  0 right, 1 left, 2 down, 3 up, and 4 for
+  // the start, which explores every direction.
+  reset(5);
+  priority_queue<entry> heap;
+  entry e = { heuristic(start), 0, start, 4 };
+  dist[start] = 0;
+  heap.push(e);
+  while (!heap.empty()) {
+    e = heap.top();
+    heap.pop();
+    if (testVisited(e.square*5 + e.dir)) continue;
+    if (e.g>dist[e.square]) continue; // Found a shorter way since.
+    setVisited(e.square*5 + e.dir);
+    int r = e.square/cols, c = e.square%cols;
+    if (grid->isTarget(r, c)) { goal = e.square; return true; }
+    expanded++;
+
+    // Which directions to jump in from here.
+    bool go[4] = { false, false, false, false };
+    if (e.dir==4) {
+      go[0] = go[1] = go[2] = go[3] = true;
+    } else if (e.dir<2) {
+      int dc = (e.dir==0) ? 1 : -1;
+      go[e.dir] = true;
+      go[2] = open(r+1, c) && !open(r+1, c-dc);
+      go[3] = open(r-1, c) && !open(r-1, c-dc);
+    } else {
+      go[e.dir] = true;
+      go[0] = go[1] = true;
+    }
+
+    for (int d=0; d<4; d++) {
+      if (!go[d]) continue;
+      int t;
+      if (d==0) t = jumpHorizontal(r, c, 1);
+      else if (d==1) t = jumpHorizontal(r, c, -1);
+      else if (d==2) t = jumpVertical(r, c, 1);
+      else t = jumpVertical(r, c, -1);
+      if (t==-1 || testVisited(t*5 + d)) continue;
+      int g = e.g + abs(t/cols - r) + abs(t%cols - c);
+      if (dist[t]!=-1 && dist[t]<g) continue;
+      if (dist[t]==-1 || g<dist[t]) {
+        dist[t] = g;
+        parent[t] = e.square;
+      }
+      entry next = { g + heuristic(t), g, t, d };
+      heap.push(next);
+    }
+  }
+  return false;
+}
@@ -0,0 +1,77 @@
+#ifndef _GRIDPATHFINDER_HPP
+#define _GRIDPATHFINDER_HPP
+
+#include <vector>
+#include <stdint.h>
+using namespace std;
+
+#include "MazeGrid.hpp"
+
+/*
+  GridPathFinder.hpp
+
+  Shortest paths through a MazeGrid without the generic
+  PuzzleState/PredDict machinery.  Squares are numbered row*cols+col,
+  the visited set is a flat bitmap and predecessors are a flat int
+  array, so a search allocates nothing per square it reaches.
+
+  Three methods:
+   - BFS expands squares in order of distance from the start.
+   - ASTAR expands squares in order of distance plus Manhattan
+     distance to the nearest target (or the exact distance, if the
+     grid's distance field has been built).
+   - JPS is A* over "jump points" only:  it slides along straight runs
+     of open squares and only stops where the path might usefully
+     turn, so long corridors and open floors cost a handful of
+     expansions instead of one per square.
+
+  All three return a shortest path (4-way moves, each costing 1).
+*/
+
+class GridPathFinder {
+ public:
+  enum method { BFS, ASTAR, JPS };
+
+  GridPathFinder(MazeGrid *);
+  ~GridPathFinder();
+
+  // Finds a shortest path from (row,col) to a $.  Returns false if
+  // there isn't one.  Otherwise path holds the square numbers from
+  // the start to the target, both included.
+  bool findPath(int row, int col, method how, vector<int> &path);
+
+  // How many squares (jump points, for JPS) the last search expanded.
+  long getExpanded() { return expanded; }
+
+ private:
+  MazeGrid *grid;
+  int rows;
+  int cols;
+  long expanded;
+
+  vector<uint64_t> visited; // one bit per square (five for JPS)
+  vector<int> parent;       // square we reached each square from
+  vector<int> dist;         // best known distance from the start
+
+  // A heap entry.  Ordered so the smallest f (then largest g) is on top.
+  struct entry {
+    int f, g, square, dir;
+    bool operator<(const entry &other) const {
+      return (f!=other.f) ? f>other.f : g<other.g;
+    }
+  };
+
+  bool open(int row, int col) { return grid->isOpen(row, col); }
+  bool testVisited(int bit) { return (visited[bit>>6] >> (bit&63)) & 1; }
+  void setVisited(int bit) { visited[bit>>6] |= (uint64_t)1 << (bit&63); }
+  void reset(int bitsPerSquare);
+  int heuristic(int square);
+
+  bool bfs(int start, int &goal);
+  bool astar(int start, int &goal);
+  bool jps(int start, int &goal);
+  int jumpHorizontal(int row, int col, int dc);
+  int jumpVertical(int row, int col, int dr);
+};
+
+#endif
@@ -0,0 +1,218 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+#include "MazeGrid.hpp"
+
+MazeGrid::MazeGrid(int r, int c, const string &config) : rows(r), cols(c) {
+  int i, j;
+
+  owned = new char[(long)rows*cols];
+  for (i=0; i<rows; i++) {
+    for (j=0; j<cols; j++) {
+      owned[i*cols+j] = config[i*cols+j];
+      if (owned[i*cols+j]=='$') {
+        // Store location of every target for badness computation.
+	targets.push_back(i*cols+j);
+      }
+    }
+  }
+  cells = owned;
+  bits = NULL;
+  stride = cols;
+  mapping = NULL;
+  mapLength = 0;
+  distance = NULL;
+  refs = 0;
+}
+
+MazeGrid::MazeGrid(int r, int c) : rows(r), cols(c) {
+  cells = NULL;
+  bits = NULL;
+  stride = cols;
+  owned = NULL;
+  mapping = NULL;
+  mapLength = 0;
+  distance = NULL;
+  refs = 0;
+}
+
+MazeGrid::~MazeGrid() {
+  delete [] owned;
+  if (mapping!=NULL) munmap(mapping, (size_t)mapLength);
+  delete [] distance;
+}
+
+bool MazeGrid::isPackedTarget(int square) {
+  return binary_search(targets.begin(), targets.end(), square);
+}
+
+MazeGrid *MazeGrid::load(const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd<0) {
+    cerr << "Can't open maze file " << path << endl;
+    return NULL;
+  }
+  struct stat info;
+  if (fstat(fd, &info)!=0 || info.st_size==0) {
+    cerr << "Can't read maze file " << path << endl;
+    close(fd);
+    return NULL;
+  }
+  long length = (long)info.st_size;
+  // Read-only and shared, so every process mapping this file uses the
+  // same pages of the OS file cache.
+  void *map = mmap(NULL, (size_t)length, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // The mapping keeps the file open.
+  if (map==MAP_FAILED) {
+    cerr << "Can't map maze file " << path << endl;
+    return NULL;
+  }
+  const char *text = (const char *)map;
+
+  // The header is short text; parse it from a copy of the first line.
+  const char *eol = (const char *)memchr(text, '\n', (size_t)min(length, 256L));
+  string kind;
+  long r = -1, c = -1, n = 0;
+  if (eol!=NULL) {
+    istringstream header(string(text, eol));
+    header >> kind >> r >> c;
+    if (kind=="MAZEBITS") header >> n;
+  }
+  long squares = r*c;
+  if (r<=0 || c<=0 || squares>=(1L<<31) || (kind!="MAZE" && kind!="MAZEBITS")) {
+    cerr << path << " is not a maze file\n";
+    munmap(map, (size_t)length);
+    return NULL;
+  }
+
+  MazeGrid *grid = new MazeGrid((int)r, (int)c);
+  grid->mapping = map;
+  grid->mapLength = length;
+  long pos = (eol - text) + 1;
+  bool ok = true;
+
+  if (kind=="MAZE") {
+    // The rows are used where they lie in the file, newlines and all.
+    grid->cells = text + pos;
+    grid->stride = c+1;
+    ok = (pos + r*(c+1) - 1 <= length);
+    for (long i=0; ok && i<r; i++) {
+      const char *row = grid->cells + i*(c+1);
+      if (i<r-1 || pos + r*(c+1) <= length) ok = (row[c]=='\n');
+      for (const char *p = (const char *)memchr(row, '$', (size_t)c); ok && p!=NULL;
+           p = (const char *)memchr(p+1, '$', (size_t)(row+c-p-1))) {
+        grid->targets.push_back((int)(i*c + (p-row)));
+      }
+    }
+  } else {
+    for (long i=0; ok && i<n; i++) {
+      const char *next = (const char *)memchr(text+pos, '\n', (size_t)(length-pos));
+      long tr = -1, tc = -1;
+      if (next!=NULL) {
+        istringstream line(string(text+pos, next));
+        line >> tr >> tc;
+        pos = (next - text) + 1;
+      }
+      ok = (tr>=0 && tr<r && tc>=0 && tc<c);
+      if (ok) grid->targets.push_back((int)(tr*c + tc));
+    }
+    ok = ok && (pos+5 <= length) && (strncmp(text+pos, "DATA\n", 5)==0);
+    pos = ((pos+5+63)/64)*64;
+    ok = ok && (pos + (squares+7)/8 <= length);
+    grid->bits = (const unsigned char *)(text + pos);
+    sort(grid->targets.begin(), grid->targets.end());
+  }
+
+  if (!ok) {
+    cerr << path << " is truncated or damaged\n";
+    delete grid;
+    return NULL;
+  }
+  return grid;
+}
+
+bool MazeGrid::save(const char *path) {
+  ofstream out(path, ios::binary);
+  out << "MAZE " << rows << " " << cols << "\n";
+  string row;
+  for (int i=0; i<rows; i++) {
+    row.clear();
+    for (int j=0; j<cols; j++) row += at(i,j);
+    out << row << '\n';
+  }
+  out.close();
+  return !out.fail();
+}
+
+bool MazeGrid::savePacked(const char *path) {
+  ofstream out(path, ios::binary);
+  ostringstream header;
+  header << "MAZEBITS " << rows << " " << cols << " " << targets.size() << "\n";
+  for (int i=0; i<(int)targets.size(); i++) {
+    header << targets[i]/cols << " " << targets[i]%cols << "\n";
+  }
+  header << "DATA\n";
+  string text = header.str();
+  text.resize(((text.size()+63)/64)*64, '\n');
+  out << text;
+
+  long squares = (long)rows*cols;
+  vector<unsigned char> packed((size_t)(squares+7)/8, 0);
+  for (long k=0; k<squares; k++) {
+    if (isOpen((int)(k/cols), (int)(k%cols))) packed[k>>3] |= (unsigned char)(1 << (k&7));
+  }
+  out.write((const char *)&packed[0], (streamsize)packed.size());
+  out.close();
+  return !out.fail();
+}
+
+void MazeGrid::buildDistanceField() {
+  if (distance!=NULL) return; // Already done; the maze can't change.
+
+  int squares = rows*cols;
+  distance = new int[squares];
+  for (int i=0; i<squares; i++) distance[i] = getUnreachable();
+
+  // Moves are reversible, so distance *to* the nearest target is
+  // distance *from* it.  Start the queue with every target at once.
+  int *queue = new int[squares];
+  int head = 0, tail = 0;
+  for (int i=0; i<(int)targets.size(); i++) {
+    distance[targets[i]] = 0;
+    queue[tail++] = targets[i];
+  }
+  const int dr[4] = {1,-1,0,0};
+  const int dc[4] = {0,0,1,-1};
+  while (head<tail) {
+    int s = queue[head++];
+    int r = s/cols, c = s%cols;
+    for (int k=0; k<4; k++) {
+      if (!isOpen(r+dr[k], c+dc[k])) continue;
+      int t = s + dr[k]*cols + dc[k];
+      if (distance[t]!=getUnreachable()) continue;
+      distance[t] = distance[s]+1;
+      queue[tail++] = t;
+    }
+  }
+  delete [] queue;
+}
+
+int MazeGrid::targetDistance(int row, int col) {
+  if (distance!=NULL) return distance[row*cols+col];
+
+  int best = getUnreachable();
+  for (int i=0; i<(int)targets.size(); i++) {
+    int d = abs(targets[i]/cols - row) + abs(targets[i]%cols - col);
+    if (d<best) best = d;
+  }
+  return best;
+}
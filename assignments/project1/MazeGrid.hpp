@@ -0,0 +1,117 @@
+#ifndef _MAZEGRID_HPP
+#define _MAZEGRID_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+/*
+  MazeGrid.hpp
+
+  The unchanging part of a MazeRunner puzzle:  the maze itself and
+  where its targets are.  Every MazeRunner state exploring the same maze
+  points at one shared MazeGrid, so a new state costs only its position.
+
+  A MazeGrid is reference counted.  It starts with no references;
+  anything that keeps a pointer to it should retain() it, and release()
+  it when done.  The last release() deletes it.
+
+  Big mazes can be loaded straight from a file with load(), which
+  memory-maps the file and reads the squares in place rather than
+  copying them.  Two file formats are understood:
+
+    MAZE <rows> <cols>            a text header line, then <rows> lines
+    <row 0>                       of exactly <cols> characters, drawn
+    ...                           as for the constructor.
+
+    MAZEBITS <rows> <cols> <n>    a header line, then the <n> targets,
+    <row> <col>                   one "row col" per line, then a line
+    ...                           "DATA".  The squares follow, starting
+    DATA                          at the next multiple of 64 bytes in
+    <rows*cols bits>              the file:  bit k of byte k/8 is set iff
+                                  square k (row-major) is open.
+
+  The packed format is an eighth the size of the text one.  Several
+  processes loading the same file share one copy of it in memory.
+*/
+
+class MazeGrid {
+ public:
+  // Takes the number of rows and columns in the maze, then a string of
+  // length row*col showing the maze, in row-major order, where a space
+  // indicates open space, $ indicates a target, and other characters
+  // indicate obstacles.
+  MazeGrid(int, int, const string &);
+
+  // Maps a maze file (either format above).  Returns NULL, after
+  // saying why on cerr, if the file can't be read or isn't a maze.
+  static MazeGrid *load(const char *path);
+  // Write this maze out in either format.  Return false on failure.
+  bool save(const char *path);
+  bool savePacked(const char *path);
+
+  void retain() { refs++; }
+  void release() { if (--refs<=0) delete this; }
+
+  int getRows() { return rows; }
+  int getCols() { return cols; }
+
+  // What's drawn at (row,col).  (Packed mazes draw every wall as X.)
+  char at(int row, int col) {
+    if (bits!=NULL) return isTarget(row,col) ? '$' : (isOpen(row,col) ? ' ' : 'X');
+    return cells[(long)row*stride+col];
+  }
+  // Can the explorer stand at (row,col)?  False outside the maze.
+  bool isOpen(int row, int col) {
+    if (row<0 || row>=rows || col<0 || col>=cols) return false;
+    if (bits!=NULL) {
+      long k = (long)row*cols+col;
+      return (bits[k>>3] >> (k&7)) & 1;
+    }
+    char c = cells[(long)row*stride+col];
+    return (c==' ') || (c=='$');
+  }
+  bool isTarget(int row, int col) {
+    if (bits!=NULL) return isPackedTarget(row*cols+col);
+    return cells[(long)row*stride+col]=='$';
+  }
+
+  // Every $ in the maze, as square numbers (row*cols+col).
+  int getTargetCount() { return (int)targets.size(); }
+  int getTarget(int i) { return targets[i]; }
+
+  // Optional, one-time:  a breadth-first search out from all the
+  // targets at once, recording how many moves each square is from the
+  // nearest one.  After this, targetDistance() is exact and O(1).
+  void buildDistanceField();
+  bool hasDistanceField() { return distance!=NULL; }
+
+  // Lower bound on the moves from (row,col) to the nearest target:
+  // the exact distance if the distance field is built (getUnreachable()
+  // if no target can be reached), else Manhattan distance to the nearest $.
+  int targetDistance(int row, int col);
+  int getUnreachable() { return rows*cols; } // more than any real distance
+
+ private:
+  ~MazeGrid(); // Use release() instead.
+  MazeGrid(const MazeGrid&); // Not copyable; share it instead.
+  MazeGrid& operator=(const MazeGrid&);
+  MazeGrid(int, int); // For load():  no squares yet.
+  bool isPackedTarget(int square);
+
+  const int rows; // number of rows
+  const int cols; // number of columns
+  // Exactly one of these holds the squares.
+  const char *cells; // rows of characters, as drawn
+  const unsigned char *bits; // one bit per square, 1 for open
+  long stride; // distance between rows in cells (cols, plus 1 in files)
+  char *owned; // cells, if we allocated them (NULL if mapped)
+  void *mapping; // the mapped file, if any, and its length
+  long mapLength;
+  vector<int> targets; // square numbers of every $ (sorted)
+  int *distance; // rows*cols moves to nearest target, or NULL if not built
+  int refs; // how many holders still need this grid
+};
+
+#endif
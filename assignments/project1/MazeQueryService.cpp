@@ -0,0 +1,98 @@
+#include <iostream>
+using namespace std;
+
+#include "MazeQueryService.hpp"
+
+MazeQueryService::MazeQueryService(long cap) : capBytes(cap) {
+  bytesUsed = 0;
+  hits = misses = evictions = 0;
+}
+
+MazeQueryService::~MazeQueryService() {
+  while (!recent.empty()) evict();
+}
+
+void MazeQueryService::evict() {
+  entry &victim = recent.back();
+  index.erase(victim.which);
+  delete [] victim.dist;
+  delete [] victim.next;
+  victim.which.first->release();
+  bytesUsed -= victim.bytes;
+  recent.pop_back();
+  evictions++;
+}
+
+MazeQueryService::entry *MazeQueryService::lookup(MazeGrid *grid, int trow, int tcol) {
+  if (!grid->isOpen(trow, tcol)) return NULL;
+  int cols = grid->getCols();
+  key k(grid, trow*cols + tcol);
+
+  map<key, list<entry>::iterator>::iterator found = index.find(k);
+  if (found!=index.end()) {
+    hits++;
+    // Move it to the front of the LRU list.
+    recent.splice(recent.begin(), recent, found->second);
+    return &recent.front();
+  }
+  misses++;
+
+  int squares = grid->getRows()*cols;
+  long bytes = 2L*squares*(long)sizeof(int);
+  while (!recent.empty() && bytesUsed+bytes>capBytes) evict();
+
+  entry e;
+  e.which = k;
+  e.dist = new int[squares];
+  e.next = new int[squares];
+  e.bytes = bytes;
+  for (int i=0; i<squares; i++) { e.dist[i] = -1; e.next[i] = -1; }
+
+  // Breadth-first out from the target.  Moves are reversible, so the
+  // square we reached s from is s's next step toward the target.
+  int *queue = new int[squares];
+  int head = 0, tail = 0;
+  e.dist[k.second] = 0;
+  queue[tail++] = k.second;
+  const int dr[4] = {1,-1,0,0};
+  const int dc[4] = {0,0,1,-1};
+  while (head<tail) {
+    int s = queue[head++];
+    int r = s/cols, c = s%cols;
+    for (int d=0; d<4; d++) {
+      if (!grid->isOpen(r+dr[d], c+dc[d])) continue;
+      int t = s + dr[d]*cols + dc[d];
+      if (e.dist[t]!=-1) continue;
+      e.dist[t] = e.dist[s]+1;
+      e.next[t] = s;
+      queue[tail++] = t;
+    }
+  }
+  delete [] queue;
+
+  grid->retain(); // The maps are no use without their maze.
+  recent.push_front(e);
+  index[k] = recent.begin();
+  bytesUsed += bytes;
+  return &recent.front();
+}
+
+bool MazeQueryService::route(MazeGrid *grid, int row, int col, int trow, int tcol, vector<int> &path) {
+  path.clear();
+  if (!grid->isOpen(row, col)) return false;
+  entry *e = lookup(grid, trow, tcol);
+  if (e==NULL) return false;
+
+  int s = row*grid->getCols() + col;
+  if (e->dist[s]==-1) return false;
+  path.reserve(e->dist[s]+1);
+  for (; s!=-1; s=e->next[s]) path.push_back(s);
+  return true;
+}
+
+int MazeQueryService::distance(MazeGrid *grid, int row, int col, int trow, int tcol) {
+  if (!grid->isOpen(row, col)) return -1;
+  entry *e = lookup(grid, trow, tcol);
+  if (e==NULL) return -1;
+  return e->dist[row*grid->getCols() + col];
+}
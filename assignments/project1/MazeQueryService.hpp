@@ -0,0 +1,70 @@
+#ifndef _MAZEQUERYSERVICE_HPP
+#define _MAZEQUERYSERVICE_HPP
+
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+using namespace std;
+
+#include "MazeGrid.hpp"
+
+/*
+  MazeQueryService.hpp
+
+  Answers many start -> target route queries against a few mazes.
+
+  The first query for a (maze, target) pair runs one breadth-first
+  search out from the target over the whole maze, recording every
+  square's distance to the target and its next step toward it.  Every
+  later query for that target, from any start, just follows the next
+  steps -- no searching.
+
+  Those maps take 8 bytes per square, so they're kept in a cache with a
+  memory cap, and the least recently used map is dropped to make room.
+*/
+
+class MazeQueryService {
+ public:
+  // capBytes bounds the memory used by cached maps.  The map for the
+  // current query is always kept, even if it alone is over the cap.
+  MazeQueryService(long capBytes);
+  ~MazeQueryService();
+
+  // Finds a shortest route in grid from (row,col) to the target square
+  // (trow,tcol).  Returns false if there isn't one.  Otherwise path
+  // holds the square numbers (row*cols+col) from start to target.
+  bool route(MazeGrid *grid, int row, int col, int trow, int tcol, vector<int> &path);
+
+  // Number of moves from (row,col) to (trow,tcol), or -1 if unreachable.
+  int distance(MazeGrid *grid, int row, int col, int trow, int tcol);
+
+  long getHits() { return hits; }
+  long getMisses() { return misses; }
+  long getEvictions() { return evictions; }
+  long getBytesUsed() { return bytesUsed; }
+
+ private:
+  typedef pair<MazeGrid*, int> key; // (maze, target square)
+
+  struct entry {
+    key which;
+    int *dist;  // moves to the target, -1 if unreachable
+    int *next;  // square one step closer to the target, -1 if none
+    long bytes;
+  };
+
+  long capBytes;
+  long bytesUsed;
+  long hits, misses, evictions;
+
+  list<entry> recent; // most recently used first
+  map<key, list<entry>::iterator> index;
+
+  // Returns the maps for this target, building them if needed, or NULL
+  // if the target isn't an open square.
+  entry *lookup(MazeGrid *grid, int trow, int tcol);
+  void evict(); // Drops the least recently used map.
+};
+
+#endif
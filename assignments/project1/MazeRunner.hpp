@@ -5,6 +5,8 @@
 #include <string>
 using namespace std;
 
+#include "MazeGrid.hpp"
+
 /*
   MazeRunner.hpp
 
@@ -13,13 +15,15 @@ using namespace std;
 
 class MazeRunner : public PuzzleState {
  public:
-  MazeRunner(int, int, string, int, int);
+  MazeRunner(int, int, const string &, int, int);
     // The constructor takes the number of rows and columns in the maze,
     // then a string of length row*col showing the maze, in row-major order,
     // where a space indicates open space, $ indicates a target, and
     // other characters indicate obstacles.
     // The last two parameters are the starting row and column.
-  MazeRunner(const MazeRunner&); // Deep copy constructor
+  MazeRunner(MazeGrid *, int, int);
+    // Explores an existing maze, starting at the given row and column.
+  MazeRunner(const MazeRunner&); // Copy constructor (shares the maze)
   ~MazeRunner();
 
   // returns true if this PuzzleState is a solution for the puzzle
@@ -47,13 +51,9 @@ class MazeRunner : public PuzzleState {
   void print (ostream& out);
 
  private:
-  const int rows; // number of rows
-  const int cols; // number of columns
-  char *maze; // array of size rows*cols to hold the maze
+  MazeGrid *grid; // the maze, shared by every state exploring it
   int my_row; // current row position of explorer
   int my_col; // current col position of explorer
-  int target_row; // location of a $ in the maze
-  int target_col;
   void move_down(); // explore downward (increase row)
   void move_up(); // explore upward (decrease row)
   void move_right(); // explore rightward (increase col)
@@ -0,0 +1,242 @@
+#include <iostream>
+#include <sstream>
+using namespace std;
+
+#include "PuzzleState.hpp"
+#include "RiverCrossing.hpp"
+
+RiverRules::RiverRules(int n, int k) : items(n), capacity(k) {
+  eats.assign(items, 0);
+  eatenBy.assign(items, 0);
+  for (int i=0; i<items; i++) {
+    ostringstream name;
+    name << "item" << i;
+    names.push_back(name.str());
+  }
+}
+
+void RiverRules::addConflict(int eater, int eaten) {
+  eats[eater] |= (uint32_t)1 << eaten;
+  eatenBy[eaten] |= (uint32_t)1 << eater;
+}
+
+bool RiverRules::isSafe(uint32_t group) {
+  for (uint32_t rest=group; rest!=0; rest &= rest-1) {
+    if (eats[__builtin_ctz(rest)] & group) return false;
+  }
+  return true;
+}
+
+template <class Visitor>
+void RiverRules::forEachCargo(uint32_t available, Visitor &visit) {
+  cargoHelper(available, 0, capacity, visit);
+}
+
+template <class Visitor>
+void RiverRules::cargoHelper(uint32_t available, uint32_t cargo, int room, Visitor &visit) {
+  // Each item is either loaded or not; only try items above the ones
+  // already chosen so each set comes up once.
+  visit(cargo);
+  if (room==0) return;
+  for (uint32_t rest=available; rest!=0; rest &= rest-1) {
+    uint32_t bit = rest & -rest;
+    cargoHelper(rest & ~bit, cargo | bit, room-1, visit);
+  }
+}
+
+RiverRules *RiverRules::wolfGoatCabbage() {
+  RiverRules *rules = new RiverRules(3, 1);
+  rules->setName(0, "wolf");
+  rules->setName(1, "goat");
+  rules->setName(2, "cabbage");
+  rules->addConflict(0, 1);
+  rules->addConflict(1, 2);
+  return rules;
+}
+
+RiverCrossing::RiverCrossing(RiverRules *r) : rules(r), state(0) { }
+
+RiverCrossing::RiverCrossing(RiverRules *r, uint32_t s) : rules(r), state(s) { }
+
+RiverCrossing::~RiverCrossing() { }
+
+bool RiverCrossing::isSolution() {
+  // We've solved it if we've gotten everything across the river.
+  return state == (rules->getFarmer() | rules->getAllItems());
+}
+
+// Items on the farmer's bank in state s.
+static inline uint32_t withFarmer(RiverRules *rules, uint32_t s) {
+  return (s & rules->getFarmer()) ? (s & rules->getAllItems())
+    : (~s & rules->getAllItems());
+}
+
+namespace {
+  // Collects the legal crossings from one state.
+  struct successorVisitor {
+    RiverRules *rules;
+    uint32_t state;
+    uint32_t bank; // items on the farmer's side
+    vector<uint32_t> next;
+    void operator()(uint32_t cargo) {
+      // Whatever stays behind must be safe without the farmer.
+      if (rules->isSafe(bank & ~cargo)) {
+        next.push_back(state ^ (rules->getFarmer() | cargo));
+      }
+    }
+  };
+}
+
+vector<PuzzleState*> RiverCrossing::getSuccessors() {
+  successorVisitor visit;
+  visit.rules = rules;
+  visit.state = state;
+  visit.bank = withFarmer(rules, state);
+  rules->forEachCargo(visit.bank, visit);
+
+  vector<PuzzleState*> result;
+  for (int i=0; i<(int)visit.next.size(); i++) {
+    result.push_back(new RiverCrossing(rules, visit.next[i]));
+  }
+  return result;
+}
+
+int RiverCrossing::getBadness() {
+  // returns an integer representing a guess of how far we are
+  // from a solution.  Bigger means farther from solution.
+
+  // The more stuff across the river, the better?
+  return -__builtin_popcount(state);
+}
+
+string RiverCrossing::getUniqId() {
+  string key(4, '\0');
+  for (int i=0; i<4; i++) key[i] = (char)(state >> (8*i));
+  return key;
+}
+
+void RiverCrossing::print (ostream& out) {
+  bool across = (state & rules->getFarmer())!=0;
+  if (!across) out << "boat ";
+  for (int i=0; i<rules->getItems(); i++) {
+    if (!(state & ((uint32_t)1 << i))) out << rules->getName(i) << " ";
+  }
+  out << "\\___river___/ ";
+  if (across) out << "boat ";
+  for (int i=0; i<rules->getItems(); i++) {
+    if (state & ((uint32_t)1 << i)) out << rules->getName(i) << " ";
+  }
+  out << endl;
+}
+
+namespace {
+  // 2 bits per state, packed 32 states to a word.
+  inline int depthMark(const vector<uint64_t> &marks, uint32_t s) {
+    return (int)((marks[s>>5] >> ((s&31)*2)) & 3);
+  }
+  inline void setMark(vector<uint64_t> &marks, uint32_t s, int mark) {
+    marks[s>>5] |= (uint64_t)mark << ((s&31)*2);
+  }
+
+  inline bool testBit(const vector<uint64_t> &bits, uint32_t s) {
+    return (bits[s>>6] >> (s&63)) & 1;
+  }
+
+  // Expands one BFS layer.
+  struct layerVisitor {
+    RiverRules *rules;
+    const vector<uint64_t> *safe;
+    vector<uint64_t> *marks;
+    vector<uint32_t> *next;
+    uint32_t state;
+    uint32_t bank;
+    int mark;
+    void operator()(uint32_t cargo) {
+      if (!testBit(*safe, bank & ~cargo)) return;
+      uint32_t t = state ^ (rules->getFarmer() | cargo);
+      if (depthMark(*marks, t)!=0) return;
+      setMark(*marks, t, mark);
+      next->push_back(t);
+    }
+  };
+
+  // Looks for a predecessor one layer closer to the start.
+  struct backVisitor {
+    RiverRules *rules;
+    const vector<uint64_t> *safe;
+    const vector<uint64_t> *marks;
+    uint32_t state;
+    int want;
+    uint32_t found;
+    bool ok;
+    void operator()(uint32_t cargo) {
+      if (ok) return;
+      uint32_t q = state ^ (rules->getFarmer() | cargo);
+      if (depthMark(*marks, q)!=want) return;
+      // Was q -> state a legal crossing?  The farmer left q's bank
+      // (the one opposite his bank in 'state') with 'cargo'.
+      if (testBit(*safe, withFarmer(rules, q) & ~cargo)) { found = q; ok = true; }
+    }
+  };
+}
+
+bool RiverCrossing::solve(RiverRules *rules, vector<uint32_t> &path, long &reached) {
+  path.clear();
+
+  // Which groups of items are safe alone, one bit per group.  A group
+  // is safe if it is without its lowest item and that item neither
+  // eats nor is eaten by the rest, so one pass fills the table.
+  uint32_t groups = rules->getFarmer();
+  vector<uint64_t> safe((size_t)((groups+63)/64), 0);
+  safe[0] = 1;
+  for (uint32_t g=1; g<groups; g++) {
+    uint32_t rest = g & (g-1);
+    if (testBit(safe, rest) && !rules->conflicts(__builtin_ctz(g), rest)) safe[g>>6] |= (uint64_t)1 << (g&63);
+  }
+
+  uint64_t states = (uint64_t)rules->getFarmer() << 1;
+  vector<uint64_t> marks((size_t)((states+31)/32), 0);
+  uint32_t goal = rules->getFarmer() | rules->getAllItems();
+
+  vector<uint32_t> layer, next;
+  layer.push_back(0);
+  setMark(marks, 0, 1);
+  reached = 1;
+  int depth = 0;
+  bool found = (goal==0);
+  while (!found && !layer.empty()) {
+    next.clear();
+    layerVisitor visit;
+    visit.rules = rules;
+    visit.safe = &safe;
+    visit.marks = &marks;
+    visit.next = &next;
+    visit.mark = 1 + (depth+1)%3;
+    for (size_t i=0; i<layer.size(); i++) {
+      visit.state = layer[i];
+      visit.bank = withFarmer(rules, layer[i]);
+      rules->forEachCargo(visit.bank, visit);
+    }
+    reached += (long)next.size();
+    depth++;
+    found = (depthMark(marks, goal)!=0);
+    layer.swap(next);
+  }
+  if (!found) return false;
+
+  // Walk back from the goal, one layer at a time.
+  path.assign(depth+1, 0);
+  path[depth] = goal;
+  for (int d=depth; d>0; d--) {
+    backVisitor back;
+    back.rules = rules;
+    back.safe = &safe;
+    back.marks = &marks;
+    back.state = path[d];
+    back.want = 1 + (d-1)%3;
+    back.ok = false;
+    rules->forEachCargo(withFarmer(rules, path[d]), back);
+    path[d-1] = back.found;
+  }
+  return true;
+}
@@ -0,0 +1,108 @@
+#ifndef _RIVERCROSSING_HPP
+#define _RIVERCROSSING_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+using namespace std;
+
+/*
+  RiverCrossing.hpp
+
+  The general form of WolfGoatCabbage:  a farmer must row N items
+  across a river in a boat that holds the farmer plus up to k items,
+  and some items eat others whenever the farmer isn't on their bank.
+
+  A state is one bitmask:  bit i (i < N) is set once item i is across,
+  and bit N is set when the farmer (and boat) is across.  So a puzzle
+  has 2^(N+1) states, and N up to 30 fits.
+*/
+
+// The fixed part of a puzzle, shared by all its states.  It must
+// outlive them.
+class RiverRules {
+ public:
+  // items:  how many things to ferry across.
+  // capacity:  how many of them the boat holds (besides the farmer).
+  RiverRules(int items, int capacity);
+
+  // Item 'eater' eats item 'eaten' if they're left alone together.
+  void addConflict(int eater, int eaten);
+  // Name used when printing; defaults to "item<i>".
+  void setName(int item, string name) { names[item] = name; }
+
+  int getItems() { return items; }
+  int getCapacity() { return capacity; }
+  string getName(int item) { return names[item]; }
+  uint32_t getFarmer() { return (uint32_t)1 << items; }
+  uint32_t getAllItems() { return getFarmer() - 1; }
+
+  // True if the items in 'group' can be left without the farmer.
+  bool isSafe(uint32_t group);
+  // True if 'item' eats or is eaten by something in 'group'.
+  bool conflicts(int item, uint32_t group) { return ((eats[item] | eatenBy[item]) & group)!=0; }
+
+  // Calls visit(cargo) for every set of at most 'capacity' items drawn
+  // from 'available' (including the empty set).
+  template <class Visitor> void forEachCargo(uint32_t available, Visitor &visit);
+
+  // The classic puzzle:  wolf eats goat, goat eats cabbage, boat holds 1.
+  static RiverRules *wolfGoatCabbage();
+
+ private:
+  int items;
+  int capacity;
+  vector<uint32_t> eats; // eats[i] has bit j set if i eats j
+  vector<uint32_t> eatenBy; // eatenBy[j] has bit i set if i eats j
+  vector<string> names;
+
+  template <class Visitor>
+  void cargoHelper(uint32_t available, uint32_t cargo, int room, Visitor &visit);
+};
+
+class RiverCrossing : public PuzzleState {
+ public:
+  RiverCrossing(RiverRules *); // Everything starts on the near bank.
+  RiverCrossing(RiverRules *, uint32_t);
+  ~RiverCrossing();
+
+  // returns true if this PuzzleState is a solution for the puzzle
+  bool isSolution();
+
+  // returns a vector of possible next positions for the puzzle.
+  vector<PuzzleState*> getSuccessors();
+
+  // If you want to use BestFS, you must assign a priority value to
+  // all puzzle states.  (If you don't want to use BestFS, you
+  // can just return 0 for all PuzzleStates.)
+  //
+  // returns an integer representing a guess of how far we are
+  // from a solution.  Bigger means farther from solution.
+  int getBadness();
+
+  // For many dictionary implementations, it's convenient to have
+  // a unique ID for each state (so we can sort them,
+  // hash them, etc.)
+  //
+  // Returns a unique string for any state:  the bitmask's four bytes.
+  string getUniqId();
+
+  // print the puzzle state
+  void print (ostream& out);
+
+  // A dedicated breadth-first search that skips PuzzleState objects
+  // and dictionaries:  the states are the integers 0..2^(N+1)-1, so
+  // "seen" is a dense array of 2 bits per state (0 for unseen, else
+  // 1 + depth mod 3, which is enough to walk a shortest path back).
+  // Returns false if the puzzle can't be solved.  Otherwise path holds
+  // the states from start to finish.  'reached' is set to the number
+  // of states the search visited.
+  static bool solve(RiverRules *rules, vector<uint32_t> &path, long &reached);
+
+ private:
+  RiverRules *rules;
+  uint32_t state;
+};
+
+#endif
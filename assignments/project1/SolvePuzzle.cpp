@@ -0,0 +1,73 @@
+/*
+  SolvePuzzle.cpp: the generic search used by solve.cpp.
+
+  Kept out of solve.cpp so other programs (e.g., sudokubench) can
+  link against it.
+*/
+
+#include <iostream>
+#include <unistd.h>
+
+#include "SolvePuzzle.hpp"
+
+using namespace std;
+
+
+// This function does the actual solving.
+void solvePuzzle(PuzzleState *start, BagOfPuzzleStates &active, PredDict &seen, vector<PuzzleState*> &solution) {
+
+  PuzzleState *state;
+  PuzzleState *temp;
+
+  active.add(start); // Must explore the successors of the start state.
+  seen.add(start,NULL); // We've seen this state.  It has no predecessor.
+
+  while (!active.is_empty()) {
+    // Loop Invariants:
+    // 'seen' contains the set of puzzle states that we know how to reach.
+    // 'active' contains the set of puzzle states that we know how to reach,
+    //    and whose successors we might not have explored yet.
+
+    state = active.remove();
+    // Note:  Do not delete this, as this PuzzleState is also in 'seen'
+
+    // The following two lines are handy for debugging, or seeing what
+    // the algorithm is doing.
+    // 221 STUDENTS:  Comment these out when you want the program to
+    // run at full speed!
+    //cout << "Exploring State: \n";
+    //state->print(cout);
+    //usleep(1000000);	// Pause for some microseconds, to let human read output
+
+    if (state->isSolution()) {
+      // Found a solution!
+      cout << "Found solution! \n";
+      state->print(cout);
+
+      // Follow predecessors to construct path to solution.
+      temp = state;
+      while (temp!=NULL) {
+	solution.push_back(temp);
+	// Guaranteed to succeed, because these states must have been
+	// added to dictionary already.
+        seen.find(temp,temp);
+      }
+      return;
+    }
+
+    vector<PuzzleState*> nextMoves = state->getSuccessors();
+    for (unsigned int i=0; i < nextMoves.size(); i++) {
+      if (!seen.find(nextMoves[i], temp)) {
+        // Never seen this state before.  Add it to 'seen' and 'active'
+        active.add(nextMoves[i]);
+        seen.add(nextMoves[i], state);
+      } else {
+	delete nextMoves[i];
+      }
+    }
+  }
+
+  // Ran out of states to explore.  No solution!
+  solution.clear();
+  return;
+}
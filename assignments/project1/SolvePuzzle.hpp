@@ -0,0 +1,17 @@
+#ifndef _SOLVEPUZZLE_HPP
+#define _SOLVEPUZZLE_HPP
+
+#include <vector>
+#include "PuzzleState.hpp"
+#include "BagOfPuzzleStates.hpp"
+#include "PredDict.hpp"
+
+// Searches from start until it finds a solution, using 'active' to
+// decide which state to explore next (stack, queue, or priority queue)
+// and 'seen' to remember states already reached.
+//
+// On success, solution holds the path back from the solution to start
+// (solution first).  If there is no solution, it is left empty.
+void solvePuzzle(PuzzleState *start, BagOfPuzzleStates &active, PredDict &seen, vector<PuzzleState*> &solution);
+
+#endif
@@ -5,94 +5,171 @@ using namespace std;
 #include "PuzzleState.hpp"
 #include "Sudoku.hpp"
 
-Sudoku::Sudoku(string config) {
-  // I assume that the string 'config' is 81 characters long,
-  // representing the initial configuration, // in row-major order.
-  // Zeroes are for empty squares, and the
+template <int BOX>
+BasicSudoku<BOX>::BasicSudoku(string config) {
+  // I assume that the string 'config' is CELLS characters long,
+  // representing the initial configuration, in row-major order.
+  // Zeroes (or dots) are for empty squares, and the
   // other digits are for squares already filled in.
 
-  blankCount = 81;
-  for (int i=0; i<9; i++) {
-    for (int j=0; j<10; j++) {
-      rowTally[i][j] = false;
-      colTally[i][j] = false;
-      zoneTally[i/3][i%3][j] = false;
-    }
+  blankCount = CELLS;
+  for (int i=0; i<SIDE; i++) {
+    rowUsed[i] = 0;
+    colUsed[i] = 0;
+    zoneUsed[i] = 0;
   }
 
-  for (int i=0; i<9; i++) {
-    for (int j=0; j<9; j++) {
-      if (config[i*9+j]=='0') grid[i][j] = 0;
-      else applyMove(i,j,config[i*9+j]-'0');
+  for (int i=0; i<SIDE; i++) {
+    for (int j=0; j<SIDE; j++) {
+      char ch = config[i*SIDE+j];
+      int digit = 0;
+      if (ch>='1' && ch<='9') digit = ch-'0';
+      else if (ch>='A' && ch<='Z') digit = ch-'A'+10;
+      else if (ch>='a' && ch<='z') digit = ch-'a'+10;
+      if (digit<1 || digit>SIDE) grid[i*SIDE+j] = 0;
+      else applyMove(i,j,digit);
     }
   }
 }
 
-Sudoku::Sudoku(const Sudoku& other) {
+template <int BOX>
+BasicSudoku<BOX>::BasicSudoku(const BasicSudoku& other) : PuzzleState() {
   blankCount = other.blankCount;
-  for (int i=0; i<9; i++) {
-    for (int j=0; j<10; j++) {
-      rowTally[i][j] = other.rowTally[i][j];
-      colTally[i][j] = other.colTally[i][j];
-      zoneTally[i/3][i%3][j] = other.zoneTally[i/3][i%3][j];
-    }
+  for (int i=0; i<SIDE; i++) {
+    rowUsed[i] = other.rowUsed[i];
+    colUsed[i] = other.colUsed[i];
+    zoneUsed[i] = other.zoneUsed[i];
   }
-
-  for (int i=0; i<9; i++) {
-    for (int j=0; j<9; j++) {
-      grid[i][j] = other.grid[i][j];
-    }
+  for (int i=0; i<CELLS; i++) {
+    grid[i] = other.grid[i];
   }
 }
 
-Sudoku::~Sudoku() { }
+template <int BOX>
+BasicSudoku<BOX>::~BasicSudoku() { }
 
-void Sudoku::applyMove(int row, int col, int digit) {
-  grid[row][col] = digit;
+template <int BOX>
+void BasicSudoku<BOX>::applyMove(int row, int col, int digit) {
+  mask bit = (mask)(1u << (digit-1));
+  grid[row*SIDE+col] = (uint8_t)digit;
   blankCount--;
-  rowTally[row][digit] = true;
-  colTally[col][digit] = true;
-  zoneTally[row/3][col/3][digit] = true;
+  rowUsed[row] |= bit;
+  colUsed[col] |= bit;
+  zoneUsed[zoneOf(row,col)] |= bit;
+}
+
+template <int BOX>
+typename BasicSudoku<BOX>::mask BasicSudoku<BOX>::candidates(int row, int col) {
+  const mask ALL = (mask)((1ull << SIDE) - 1);
+  return (mask)(ALL & ~(rowUsed[row] | colUsed[col] | zoneUsed[zoneOf(row,col)]));
 }
 
-bool Sudoku::isSolution() {
+template <int BOX>
+bool BasicSudoku<BOX>::isSolution() {
   // Since we make only legal moves, we've solved when all squares filled in.
   return blankCount==0;
 }
 
+// Index of the lowest set bit, plus one:  the digit a single-bit mask means.
+static inline int maskDigit(uint32_t m) { return __builtin_ctz(m) + 1; }
+
+template <int BOX>
+bool BasicSudoku<BOX>::propagate() {
+  // Repeatedly apply the two simplest Sudoku deductions until neither
+  // one fills in anything new:
+  //  - a naked single is a blank square with only one legal digit;
+  //  - a hidden single is a digit with only one legal square in some
+  //    row, column, or zone.
+  // A blank square with no legal digit, or a digit with nowhere to go
+  // in a unit that still needs it, means this grid can't be solved.
+  const mask ALL = (mask)((1ull << SIDE) - 1);
+  bool changed = true;
+  while (changed && blankCount>0) {
+    changed = false;
+
+    // Naked singles
+    for (int i=0; i<SIDE; i++) {
+      for (int j=0; j<SIDE; j++) {
+        if (grid[i*SIDE+j]!=0) continue;
+        mask c = candidates(i,j);
+        if (c==0) return false;
+        if ((c & (c-1))==0) { applyMove(i,j,maskDigit(c)); changed = true; }
+      }
+    }
 
-vector<PuzzleState*> Sudoku::getSuccessors() {
+    // Hidden singles.  Unit u is row u for u<SIDE, column u-SIDE for
+    // u<2*SIDE, and zone u-2*SIDE otherwise.  'once' collects digits
+    // that fit at least one blank in the unit, 'twice' at least two.
+    for (int u=0; u<3*SIDE; u++) {
+      mask once = 0, twice = 0, used;
+      if (u<SIDE) used = rowUsed[u];
+      else if (u<2*SIDE) used = colUsed[u-SIDE];
+      else used = zoneUsed[u-2*SIDE];
+      for (int k=0; k<SIDE; k++) {
+        int i, j;
+        if (u<SIDE) { i = u; j = k; }
+        else if (u<2*SIDE) { i = k; j = u-SIDE; }
+        else { i = ((u-2*SIDE)/BOX)*BOX + k/BOX; j = ((u-2*SIDE)%BOX)*BOX + k%BOX; }
+        if (grid[i*SIDE+j]!=0) continue;
+        mask c = candidates(i,j);
+        twice |= (mask)(once & c);
+        once |= c;
+      }
+      if ((mask)(once | used)!=ALL) return false; // A digit has nowhere to go.
+      mask hidden = (mask)(once & ~twice);
+      for (int k=0; k<SIDE && hidden!=0; k++) {
+        int i, j;
+        if (u<SIDE) { i = u; j = k; }
+        else if (u<2*SIDE) { i = k; j = u-SIDE; }
+        else { i = ((u-2*SIDE)/BOX)*BOX + k/BOX; j = ((u-2*SIDE)%BOX)*BOX + k%BOX; }
+        if (grid[i*SIDE+j]!=0) continue;
+        mask h = (mask)(candidates(i,j) & hidden);
+        if (h==0) continue;
+        // An earlier placement in this pass may have used the digit up.
+        applyMove(i,j,maskDigit(h));
+        hidden &= (mask)~h;
+        changed = true;
+      }
+    }
+  }
+  return true;
+}
+
+template <int BOX>
+vector<PuzzleState*> BasicSudoku<BOX>::getSuccessors() {
 
   vector<PuzzleState*> result;
 
-  // find a blank square to fill in
-  int row = 0;
-  int col = 0;
-  for (int i=0; i<9; i++) {
-    for (int j=0; j<9; j++) {
-      if (grid[i][j]==0) {
-	row = i;
-	col = j;
-	goto foundOne;
-      }
+  // find the blank square with the fewest legal digits to fill in
+  int row = -1;
+  int col = -1;
+  int fewest = SIDE+1;
+  for (int i=0; i<SIDE && fewest>1; i++) {
+    for (int j=0; j<SIDE && fewest>1; j++) {
+      if (grid[i*SIDE+j]!=0) continue;
+      int count = __builtin_popcount(candidates(i,j));
+      if (count<fewest) { fewest = count; row = i; col = j; }
     }
   }
-foundOne:
-
-  for (int digit=1; digit<=9; digit++) {
-    if (rowTally[row][digit]) continue; // digit already used in row
-    if (colTally[col][digit]) continue; // digit already used in column
-    if (zoneTally[row/3][col/3][digit]) continue; // digit already used in zone
-    // This is a legal digit!  Add it to possible moves.
-    Sudoku *temp = new Sudoku(*this);
-    temp->applyMove(row,col,digit);
+  if (row<0) return result; // No blanks left, so no moves.
+
+  for (mask c=candidates(row,col); c!=0; c &= (mask)(c-1)) {
+    // This is a legal digit!  Fill it in, along with everything it forces.
+    BasicSudoku *temp = new BasicSudoku(*this);
+    temp->applyMove(row,col,maskDigit(c));
+    if (!temp->propagate()) {
+      // Dead end, so prune this branch right away.
+      delete temp;
+      continue;
+    }
     result.push_back(temp);
   }
 
   return result;
 }
 
-int Sudoku::getBadness() {
+template <int BOX>
+int BasicSudoku<BOX>::getBadness() {
   // returns an integer representing a guess of how far we are
   // from a solution.  Bigger means farther from solution.
 
@@ -101,20 +178,33 @@ int Sudoku::getBadness() {
   return blankCount;
 }
 
-string Sudoku::getUniqId() {
-  // This is a bit of a kludge, but it's easy.
-  // We'll just use the print method to convert the PuzzleState
-  // into a string representation.
-  ostringstream temp;
-  print(temp);
-  return temp.str();
+template <int BOX>
+string BasicSudoku<BOX>::getUniqId() {
+  // Pack the squares KEY_BITS at a time, so the key is about half
+  // the size of the grid (and a small fraction of its printout).
+  string key((CELLS*KEY_BITS + 7)/8, '\0');
+  int bit = 0;
+  for (int i=0; i<CELLS; i++) {
+    for (int b=0; b<KEY_BITS; b++, bit++) {
+      if (grid[i] & (1 << b)) key[bit/8] = (char)(key[bit/8] | (1 << (bit%8)));
+    }
+  }
+  return key;
 }
 
-void Sudoku::print (ostream& out) {
-  for (int i=0; i<9; i++) {
-    for (int j=0; j<9; j++) {
-      out << " " << grid[i][j];
+template <int BOX>
+void BasicSudoku<BOX>::print (ostream& out) {
+  for (int i=0; i<SIDE; i++) {
+    for (int j=0; j<SIDE; j++) {
+      int digit = grid[i*SIDE+j];
+      out << " " << (char)((digit<10) ? '0'+digit : 'A'+digit-10);
     }
     out << endl;
   }
 }
+
+// Sizes the rest of the program may ask for.
+template class BasicSudoku<2>;
+template class BasicSudoku<3>;
+template class BasicSudoku<4>;
+template class BasicSudoku<5>;
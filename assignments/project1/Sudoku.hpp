@@ -3,19 +3,42 @@
 
 #include <iostream>
 #include <string>
+#include <stdint.h>
 using namespace std;
 
 /*
   Sudoku.hpp
 
   Everyone knows Sudoku!
+
+  The grid is BOX*BOX squares on a side, split into BOX*BOX zones of
+  BOX x BOX squares, so BasicSudoku<3> is the usual 9x9 puzzle (which
+  is what plain Sudoku means), BasicSudoku<4> is 16x16 and
+  BasicSudoku<5> is 25x25.
 */
 
-class Sudoku : public PuzzleState {
+// Bitmask type big enough to hold one bit per digit.
+template <int BOX> struct SudokuMask { typedef uint32_t type; };
+template <> struct SudokuMask<2> { typedef uint16_t type; };
+template <> struct SudokuMask<3> { typedef uint16_t type; };
+template <> struct SudokuMask<4> { typedef uint16_t type; };
+
+template <int BOX>
+class BasicSudoku : public PuzzleState {
  public:
-  Sudoku(string);
-  Sudoku(const Sudoku&); // Deep copy constructor
-  ~Sudoku();
+  enum {
+    SIDE = BOX*BOX,    // squares per row, column or zone; also the digits
+    CELLS = SIDE*SIDE, // squares in the grid
+    // bits needed per square in getUniqId() (it holds 0..SIDE)
+    KEY_BITS = (SIDE<8) ? 3 : (SIDE<16) ? 4 : (SIDE<32) ? 5 : 6
+  };
+  typedef typename SudokuMask<BOX>::type mask;
+
+  // The string holds CELLS characters in row-major order.  '0' or '.'
+  // is a blank; digits 1-9 are '1'-'9' and 10 and up are 'A', 'B', ...
+  BasicSudoku(string);
+  BasicSudoku(const BasicSudoku&); // Deep copy constructor
+  ~BasicSudoku();
 
   // returns true if this PuzzleState is a solution for the puzzle
   bool isSolution();
@@ -35,22 +58,31 @@ class Sudoku : public PuzzleState {
   // a unique ID for each state (so we can sort them,
   // hash them, etc.)
   //
-  // Returns a unique string for any state
+  // Returns a unique string for any state:  the grid packed KEY_BITS
+  // per square.
   string getUniqId(void);
 
   // print the puzzle state
   void print (ostream& out);
  private:
-  int grid[9][9]; // array to hold the grid, 0 for blanks
+  uint8_t grid[CELLS]; // the grid in row-major order, 0 for blanks
   // Below are helper fields, that make the code more efficient
   // and easier to write.
   // It's important to maintain class invariants (like loop invariants)
   // that all methods maintain these variables with accurate values.
   int blankCount; // how many blank spaces left
-  bool rowTally[9][10]; // for each row, have we used a given digit yet?
-  bool colTally[9][10]; // similar, for each column
-  bool zoneTally[3][3][10]; // similar, for each zone
+  mask rowUsed[SIDE]; // for each row, bit d-1 is set if d is used already
+  mask colUsed[SIDE]; // similar, for each column
+  mask zoneUsed[SIDE]; // similar, for each zone (numbered row-major)
+
+  static int zoneOf(int row, int col) { return (row/BOX)*BOX + col/BOX; }
   void applyMove(int row, int col, int digit); // Writes a digit into the grid
+  mask candidates(int row, int col); // Digits that can go at (row,col)
+  // Fills in forced cells (naked and hidden singles) until nothing
+  // more is forced.  Returns false if the grid hits a contradiction.
+  bool propagate();
 };
 
+typedef BasicSudoku<3> Sudoku;
+
 #endif
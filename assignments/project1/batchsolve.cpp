@@ -0,0 +1,115 @@
+/*
+  batchsolve.cpp: contains 'main' function.
+
+  batchsolve <puzzles> <answers> [threads]
+      Solves a file of 81 character Sudoku puzzles, one per line,
+      writing one answer line per puzzle to the answers file.
+
+  batchsolve -bench [count] [threads]
+      Generates count puzzles (by shuffling a few known grids) and
+      reports how many puzzles per second BatchSudoku solves.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "BatchSudoku.hpp"
+
+using namespace std;
+
+// Rearranges a puzzle without changing how hard it is:  relabels the
+// digits, shuffles rows within each band and the bands themselves,
+// and sometimes transposes.
+string shuffled(const string &grid, unsigned int &seed) {
+  seed = seed*1103515245u + 12345u;
+  int digits[10] = {0,1,2,3,4,5,6,7,8,9};
+  for (int i=9; i>1; i--) {
+    seed = seed*1103515245u + 12345u;
+    int j = 1 + (int)((seed>>16) % (unsigned)i);
+    int t = digits[i]; digits[i] = digits[j]; digits[j] = t;
+  }
+  int rows[9];
+  int band[3] = {0,1,2};
+  for (int i=2; i>0; i--) {
+    seed = seed*1103515245u + 12345u;
+    int j = (int)((seed>>16) % (unsigned)(i+1));
+    int t = band[i]; band[i] = band[j]; band[j] = t;
+  }
+  for (int b=0; b<3; b++) {
+    int order[3] = {0,1,2};
+    for (int i=2; i>0; i--) {
+      seed = seed*1103515245u + 12345u;
+      int j = (int)((seed>>16) % (unsigned)(i+1));
+      int t = order[i]; order[i] = order[j]; order[j] = t;
+    }
+    for (int k=0; k<3; k++) rows[b*3+k] = band[b]*3 + order[k];
+  }
+  seed = seed*1103515245u + 12345u;
+  bool transpose = (seed>>16) & 1;
+
+  string out(81,'0');
+  for (int r=0; r<9; r++) {
+    for (int c=0; c<9; c++) {
+      int from = transpose ? (c*9 + rows[r]) : (rows[r]*9 + c);
+      out[r*9+c] = (char)('0' + digits[grid[from]-'0']);
+    }
+  }
+  return out;
+}
+
+int bench(long count, int threads) {
+  const char *seeds[] = {
+    "927430008060000097008000402000308005400060003800201000602000300790000080500089271",
+    "167000000050600047000300009641057000800060005000980716700008000490006050000000671",
+    "003020600900305001001806400008102900700000008006708200002609500800203009005010300",
+    "000000010400000000020000000000050407008000300001090000300400200050100000000806000"
+  };
+  vector<string> puzzles;
+  unsigned int seed = 221;
+  for (long i=0; i<count; i++) puzzles.push_back(shuffled(seeds[i%4], seed));
+
+  BatchSudoku solver(threads);
+  vector<string> answers;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  solver.solveBatch(puzzles, answers);
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  double seconds = elapsed.count();
+
+  long solved = 0;
+  for (long i=0; i<count; i++) if (answers[i].length()==81) solved++;
+  cout << count << " puzzles (" << solved << " solved) on "
+       << solver.getThreads() << " threads in " << seconds << " s: "
+       << (double)count/seconds << " puzzles/s\n";
+  return (solved==count) ? 0 : 1;
+}
+
+int main (int argc, char *argv[])
+{
+  if (argc>1 && strcmp(argv[1],"-bench")==0) {
+    long count = (argc>2) ? atol(argv[2]) : 100000;
+    int threads = (argc>3) ? atoi(argv[3]) : 0;
+    return bench(count, threads);
+  }
+  if (argc<3) {
+    cerr << "usage: " << argv[0] << " <puzzles> <answers> [threads]\n"
+         << "       " << argv[0] << " -bench [count] [threads]\n";
+    return 2;
+  }
+
+  ifstream in(argv[1]);
+  if (!in) { cerr << "Can't read " << argv[1] << endl; return 1; }
+  ofstream out(argv[2]);
+  if (!out) { cerr << "Can't write " << argv[2] << endl; return 1; }
+
+  BatchSudoku solver((argc>3) ? atoi(argv[3]) : 0);
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  long count = solver.solveStream(in, out);
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  cerr << count << " puzzles in " << elapsed.count() << " s\n";
+  return 0;
+}
@@ -0,0 +1,174 @@
+/*
+  mazepath.cpp: contains 'main' function.
+
+  mazepath
+      Runs BFS, A* and JPS on the example maze from solve.cpp, then
+      A* again with the maze's distance field as its heuristic.
+  mazepath <rows> <cols> <percent walls> [seed]
+      Same, on a randomly generated open floor with that many
+      scattered walls, from the top left corner to the bottom right.
+  mazepath <maze file>
+      Same, on a maze file (see MazeGrid.hpp), from its first open square.
+  mazepath -save <maze file> <rows> <cols> <percent walls> [seed]
+  mazepath -pack <maze file> <rows> <cols> <percent walls> [seed]
+      Writes a generated floor to a file, as text or packed bits.
+  mazepath -queries <count> <targets> <rows> <cols> <percent walls> [seed]
+      Answers count random queries, to one of a few random targets, on
+      a generated floor through MazeQueryService, and compares the time
+      with searching from scratch for every query.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "MazeGrid.hpp"
+#include "GridPathFinder.hpp"
+#include "MazeQueryService.hpp"
+
+using namespace std;
+
+void race(MazeGrid *grid, int row, int col) {
+  GridPathFinder finder(grid);
+  const char *names[] = { "BFS", "A*", "JPS" };
+  GridPathFinder::method methods[] = { GridPathFinder::BFS,
+    GridPathFinder::ASTAR, GridPathFinder::JPS };
+
+  cout << "method\tlength\texpanded\tms\n";
+  for (int m=0; m<3; m++) {
+    vector<int> path;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    bool found = finder.findPath(row, col, methods[m], path);
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    cout << names[m] << "\t";
+    if (found) cout << path.size()-1; else cout << "none";
+    cout << "\t" << finder.getExpanded() << "\t\t" << elapsed.count() << endl;
+  }
+
+  // With the exact distance field, A* walks straight down the path.
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  grid->buildDistanceField();
+  chrono::duration<double, milli> built = chrono::steady_clock::now() - start;
+  vector<int> path;
+  start = chrono::steady_clock::now();
+  bool found = finder.findPath(row, col, GridPathFinder::ASTAR, path);
+  chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+  cout << "A*+field\t";
+  if (found) cout << path.size()-1; else cout << "none";
+  cout << "\t" << finder.getExpanded() << "\t\t" << elapsed.count()
+       << " (+" << built.count() << " to build field)" << endl;
+}
+
+MazeGrid *generate(int argc, char *argv[]) {
+  int rows = atoi(argv[0]);
+  int cols = atoi(argv[1]);
+  int percent = atoi(argv[2]);
+  srand((argc>3) ? (unsigned)atoi(argv[3]) : 221u);
+  string floor((size_t)rows*cols, ' ');
+  for (size_t i=0; i<floor.size(); i++) {
+    if (rand()%100 < percent) floor[i] = 'X';
+  }
+  floor[0] = ' ';
+  floor[floor.size()-1] = '$';
+  return new MazeGrid(rows, cols, floor);
+}
+
+// A random open square.
+int randomOpen(MazeGrid *grid) {
+  int r, c;
+  do {
+    r = rand()%grid->getRows();
+    c = rand()%grid->getCols();
+  } while (!grid->isOpen(r, c));
+  return r*grid->getCols() + c;
+}
+
+int queries(int argc, char *argv[]) {
+  int count = atoi(argv[0]);
+  int distinct = atoi(argv[1]);
+  if (count < 1 || distinct < 1) {
+    cerr << "mazepath:  -queries needs at least one query and one target" << endl;
+    return 1;
+  }
+  MazeGrid *grid = generate(argc-2, argv+2);
+  grid->retain();
+  int cols = grid->getCols();
+
+  // Each query's start and target, drawn up front so that both passes
+  // below answer the very same queries.
+  vector<int> targets, starts, goals;
+  for (int i=0; i<distinct; i++) targets.push_back(randomOpen(grid));
+  for (int i=0; i<count; i++) {
+    starts.push_back(randomOpen(grid));
+    goals.push_back(targets[rand()%distinct]);
+  }
+
+  // Room for all but one target's maps, so some get evicted.
+  long cap = (long)grid->getRows()*cols*8L*((distinct>1) ? distinct-1 : 1);
+  MazeQueryService service(cap);
+  vector<int> path;
+  long cachedMoves = 0;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (int i=0; i<count; i++) {
+    int t = goals[i];
+    if (service.route(grid, starts[i]/cols, starts[i]%cols, t/cols, t%cols, path))
+      cachedMoves += (long)path.size()-1;
+  }
+  chrono::duration<double, milli> cached = chrono::steady_clock::now() - start;
+  cout << "service:\t" << cached.count()/count << " ms/query, "
+       << service.getHits() << " hits, " << service.getMisses() << " misses, "
+       << service.getEvictions() << " evictions, total moves " << cachedMoves << endl;
+
+  // The same queries with no room to cache anything:  every query
+  // searches the maze from scratch (first 100 only).
+  int fresh = (count<100) ? count : 100;
+  MazeQueryService uncached(0);
+  start = chrono::steady_clock::now();
+  for (int i=0; i<fresh; i++) {
+    int t = goals[i];
+    uncached.route(grid, starts[i]/cols, starts[i]%cols, t/cols, t%cols, path);
+  }
+  chrono::duration<double, milli> searched = chrono::steady_clock::now() - start;
+  cout << "uncached:\t" << searched.count()/fresh << " ms/query\n";
+
+  grid->release();
+  return 0;
+}
+
+int main (int argc, char *argv[])
+{
+  MazeGrid *grid;
+  if (argc>6 && strcmp(argv[1],"-queries")==0) return queries(argc-2, argv+2);
+  if (argc>5 && (strcmp(argv[1],"-save")==0 || strcmp(argv[1],"-pack")==0)) {
+    grid = generate(argc-3, argv+3);
+    grid->retain();
+    bool ok = (argv[1][1]=='s') ? grid->save(argv[2]) : grid->savePacked(argv[2]);
+    grid->release();
+    if (!ok) cerr << "Can't write " << argv[2] << endl;
+    return ok ? 0 : 1;
+  }
+
+  int row = 0, col = 0;
+  if (argc>3) {
+    grid = generate(argc-1, argv+1);
+  } else if (argc==2) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    grid = MazeGrid::load(argv[1]);
+    if (grid==NULL) return 1;
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    cout << "Loaded " << grid->getRows() << "x" << grid->getCols() << " maze with "
+         << grid->getTargetCount() << " targets in " << elapsed.count() << " ms\n";
+    while (row<grid->getRows() && !grid->isOpen(row, col)) {
+      if (++col==grid->getCols()) { col = 0; row++; }
+    }
+  } else {
+    grid = new MazeGrid(11,30,"    X                 X    X  XX XXXXXXXX  XXXXXX   X   XX   X X    X$    X  X   XXX  X    X X XXXXXXX  X      X    X  X X X          X  XXXXXX  XX XX   X          X  X       X  X    XXXXXXXXXXXX  X  XXXXXX  X      X      X   XXX  X  X   X X    X  X   X        X  X   X X    X  X   X   X    X  X   X X       X       X             ");
+  }
+  grid->retain();
+  race(grid, row, col);
+  grid->release();
+  return 0;
+}
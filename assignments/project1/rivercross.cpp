@@ -0,0 +1,82 @@
+/*
+  rivercross.cpp: contains 'main' function.
+
+  rivercross
+      Solves WolfGoatCabbage as a RiverCrossing, once with the generic
+      solver (PuzzleState + dictionary) and once with the dedicated
+      bit-state search, and prints the crossings.
+  rivercross <items> <capacity> <percent conflicts> [seed]
+      Runs the bit-state search on a random puzzle:  each ordered pair
+      of items is a conflict with the given chance.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+#include "PuzzleState.hpp"
+#include "RiverCrossing.hpp"
+#include "ArrayStack.hpp"
+#include "LinkedListDict.hpp"
+#include "SolvePuzzle.hpp"
+
+using namespace std;
+
+void report(RiverRules *rules, bool printPath) {
+  vector<uint32_t> path;
+  long reached;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  bool found = RiverCrossing::solve(rules, path, reached);
+  chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+
+  cout << "bit-state search: ";
+  if (found) cout << path.size()-1 << " crossings";
+  else cout << "no solution";
+  cout << ", " << reached << " states reached, " << elapsed.count() << " ms" << endl;
+  if (found && printPath) {
+    for (size_t i=0; i<path.size(); i++) {
+      RiverCrossing(rules, path[i]).print(cout);
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc==1) {
+    RiverRules *rules = RiverRules::wolfGoatCabbage();
+    cout << "generic solver (DFS):" << endl;
+    ArrayStack activeStates;
+    LinkedListDict seenStates;
+    vector<PuzzleState*> solution;
+    solvePuzzle(new RiverCrossing(rules), activeStates, seenStates, solution);
+    for (int i=(int)solution.size()-1; i >= 0; i--) solution[i]->print(cout);
+    report(rules, true);
+    delete rules;
+    return 0;
+  }
+  if (argc < 4) {
+    cerr << "usage: rivercross [<items> <capacity> <percent conflicts> [seed]]" << endl;
+    return 1;
+  }
+
+  int items = atoi(argv[1]);
+  int capacity = atoi(argv[2]);
+  int percent = atoi(argv[3]);
+  if (items < 1 || items > 30 || capacity < 0) {
+    cerr << "rivercross: need 1 to 30 items and a capacity of at least 0" << endl;
+    return 1;
+  }
+  srand((argc>4) ? (unsigned)atoi(argv[4]) : 221u);
+  RiverRules *rules = new RiverRules(items, capacity);
+  int conflicts = 0;
+  for (int i=0; i<items; i++) {
+    for (int j=0; j<items; j++) {
+      if (i!=j && rand()%100 < percent) { rules->addConflict(i, j); conflicts++; }
+    }
+  }
+  cout << items << " items, boat holds " << capacity << ", "
+       << conflicts << " conflicts" << endl;
+  report(rules, items <= 8);
+  delete rules;
+  return 0;
+}
@@ -13,6 +13,7 @@
 // you create and use here
 #include "PuzzleState.hpp"
 #include "WolfGoatCabbage.hpp"
+#include "RiverCrossing.hpp"
 #include "SliderPuzzle.hpp"
 #include "Sudoku.hpp"
 #include "MazeRunner.hpp"
@@ -27,72 +28,35 @@
 
 #include "LinkedListDict.hpp"
 
+#include "SolvePuzzle.hpp"
+#include "DancingLinks.hpp"
+
 using namespace std;
 
 
-// This function does the actual solving.
-void solvePuzzle(PuzzleState *start, BagOfPuzzleStates &active, PredDict &seen, vector<PuzzleState*> &solution) {
-
-  PuzzleState *state;
-  PuzzleState *temp;
-
-  active.add(start); // Must explore the successors of the start state.
-  seen.add(start,NULL); // We've seen this state.  It has no predecessor.
-
-  while (!active.is_empty()) {
-    // Loop Invariants:
-    // 'seen' contains the set of puzzle states that we know how to reach.
-    // 'active' contains the set of puzzle states that we know how to reach,
-    //    and whose successors we might not have explored yet.
-
-    state = active.remove();
-    // Note:  Do not delete this, as this PuzzleState is also in 'seen'
-
-    // The following two lines are handy for debugging, or seeing what
-    // the algorithm is doing.
-    // 221 STUDENTS:  Comment these out when you want the program to
-    // run at full speed!
-    cout << "Exploring State: \n";
-    state->print(cout);
-    usleep(1000000);	// Pause for some microseconds, to let human read output
-
-    if (state->isSolution()) {
-      // Found a solution!
-      cout << "Found solution! \n";
-      state->print(cout);
-
-      // Follow predecessors to construct path to solution.
-      temp = state;
-      while (temp!=NULL) {
-	solution.push_back(temp);
-	// Guaranteed to succeed, because these states must have been
-	// added to dictionary already.
-        seen.find(temp,temp);
-      }
-      return;
-    }
+int main (int argc, char *argv[])
+{
+  PuzzleState *startState;
 
-    vector<PuzzleState*> nextMoves = state->getSuccessors();
-    for (unsigned int i=0; i < nextMoves.size(); i++) {
-      if (!seen.find(nextMoves[i], temp)) {
-        // Never seen this state before.  Add it to 'seen' and 'active'
-        active.add(nextMoves[i]);
-        seen.add(nextMoves[i], state);
-      } else {
-	delete nextMoves[i];
+  // Sudoku can skip the generic search and go straight to the
+  // exact cover solver:  solve -dlx <81 digit grid>
+  if (argc>2 && strcmp(argv[1],"-dlx")==0) {
+    DancingLinks dlx;
+    string grid;
+    if (!dlx.solve(argv[2], grid)) {
+      cout << "No solution!\n";
+      return 1;
+    }
+    cout << "Found solution! \n";
+    for (int i=0; i<9; i++) {
+      for (int j=0; j<9; j++) {
+	cout << " " << grid[i*9+j];
       }
+      cout << endl;
     }
+    return 0;
   }
 
-  // Ran out of states to explore.  No solution!
-  solution.clear();
-  return;
-}
-
-int main ()
-{
-  PuzzleState *startState;
-
   // 221 STUDENTS: Initialize startState with an object of the type
   // of puzzle you want solved.
   // For some kinds of puzzles, you will want to pass in a parameter
@@ -101,6 +65,9 @@ int main ()
   // This is for the WolfGoatCabbage problem.
   startState = new WolfGoatCabbage();
 
+  // The same puzzle, as one member of the RiverCrossing family:
+  //startState = new RiverCrossing(RiverRules::wolfGoatCabbage());
+
   // This is an empty Sudoku grid:
   //startState = new Sudoku("000000000000000000000000000000000000000000000000000000000000000000000000000000000");
 
@@ -0,0 +1,87 @@
+/*
+  sudokubench.cpp: contains 'main' function.
+
+  Times the Dancing Links solver against the generic solvePuzzle
+  search (Sudoku + ArrayStack + LinkedListDict) on a few grids.
+*/
+
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "PuzzleState.hpp"
+#include "Sudoku.hpp"
+#include "ArrayStack.hpp"
+#include "LinkedListDict.hpp"
+#include "SolvePuzzle.hpp"
+#include "DancingLinks.hpp"
+
+using namespace std;
+
+typedef chrono::steady_clock bench_clock;
+
+// Microseconds per solve, averaged over reps solves.
+double timeDancingLinks(DancingLinks &dlx, string grid, int reps, string &answer) {
+  bench_clock::time_point start = bench_clock::now();
+  for (int i=0; i<reps; i++) dlx.solve(grid, answer);
+  chrono::duration<double, micro> elapsed = bench_clock::now() - start;
+  return elapsed.count() / reps;
+}
+
+double timeGeneric(string grid, int reps, string &answer) {
+  // solvePuzzle announces its solution on cout, so send that elsewhere.
+  ostringstream sink;
+  streambuf *saved = cout.rdbuf(sink.rdbuf());
+
+  bench_clock::time_point start = bench_clock::now();
+  for (int i=0; i<reps; i++) {
+    ArrayStack activeStates;
+    LinkedListDict seenStates;
+    vector<PuzzleState*> solution;
+    solvePuzzle(new Sudoku(grid), activeStates, seenStates, solution);
+    if (i==0 && !solution.empty()) {
+      ostringstream out;
+      solution[0]->print(out);
+      answer = out.str();
+    }
+  }
+  chrono::duration<double, micro> elapsed = bench_clock::now() - start;
+
+  cout.rdbuf(saved);
+  return elapsed.count() / reps;
+}
+
+int main ()
+{
+  const char *names[] = { "easy", "medium", "hard", "empty" };
+  const char *grids[] = {
+    "927430008060000097008000402000308005400060003800201000602000300790000080500089271",
+    "167000000050600047000300009641057000800060005000980716700008000490006050000000671",
+    "800000000003600000070090200050007000000045700000100030001000068008500010090000400",
+    "000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+  };
+  const int DLX_REPS = 2000;
+  const int GENERIC_REPS = 20;
+
+  DancingLinks dlx;
+  cout << "grid\tdlx us\tgeneric us\tspeedup\n";
+  for (int i=0; i<4; i++) {
+    string fast, slow;
+    double dlxTime = timeDancingLinks(dlx, grids[i], DLX_REPS, fast);
+    double genericTime = timeGeneric(grids[i], GENERIC_REPS, slow);
+
+    // Check the two agree (Sudoku::print puts a space before each digit).
+    string printed;
+    for (int k=0; k<81; k++) {
+      printed += ' ';
+      printed += fast[k];
+      if (k%9==8) printed += '\n';
+    }
+    cout << names[i] << "\t" << dlxTime << "\t" << genericTime << "\t"
+         << genericTime/dlxTime << "x"
+         << ((i<3 && printed!=slow) ? "\t(MISMATCH!)" : "") << endl;
+  }
+  return 0;
+}
@@ -3,9 +3,21 @@
 #define _AVLDICT_HPP
 
 #include "PredDict.hpp"
+#include "StatCounter.hpp"
+#include <stdint.h>
+#include <vector>
 
 // An implementation of a dictionary ADT as an AVL tree.
 //
+// Nodes live in one growing array and point at each other by 32-bit
+// index, with index 0 standing for "no node" (its height is -1).  The
+// tree is ordered by a 64-bit hash of the keyID, and by the keyID
+// itself only when two hashes tie, so a search nearly always compares
+// one integer per level.  The keys and keyIDs are kept in a second
+// array, out of the way of the hot node fields.  find() and add()
+// walk the tree in a loop; add() remembers its path on a stack for the
+// trip back up.
+//
 class AVLDict : public PredDict
   {
   public:
@@ -13,34 +25,51 @@ class AVLDict : public PredDict
     ~AVLDict();
     bool find(PuzzleState *key, PuzzleState *&pred);
     void add(PuzzleState *key, PuzzleState *pred);
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred);
+    // The same, given key's getUniqId(); a new node takes keyID over.
+    bool find(PuzzleState *key, const string &keyID, PuzzleState *&pred);
+    void add(PuzzleState *key, PuzzleState *pred, string &keyID);
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, string &keyID, PuzzleState *&found_pred);
 
   private:
     struct node {
-      PuzzleState *key;
-      string keyID; // Avoid recomputation of key's getUniqId()
+      uint64_t hash; // Hash of the key's getUniqId()
       PuzzleState *data;
+      uint32_t left;
+      uint32_t right;
       int height; // Avoid recomputation of subtree height.
-      node *left;
-      node *right;
     };
 
-    node *root;
+    struct cold_node { // Only needed when hashes tie, or to clean up.
+      PuzzleState *key;
+      string keyID; // Avoid recomputation of key's getUniqId()
+    };
+
+    const static uint32_t NIL = 0; // pool[NIL] is the empty tree
+
+    vector<node> pool;
+    vector<cold_node> cold; // cold[i] goes with pool[i]
+    uint32_t root;
+    vector<uint32_t *> path; // add()'s stack of links from root down
 
     // The next two variables are just to collect statistics on the
     // number of probes required for each call to find().
-    int *depth_stats; // probe_stats[i] should be how often i probes needed
+    stat_counter *depth_stats; // probe_stats[i] should be how often i probes needed
     const static int MAX_STATS = 30; // How big to make the array.
 
-    void destructor_helper(node * x);
-    bool find_helper(node *r, string keyID, PuzzleState *&pred, int depth);
+    uint64_t hash(const string &keyID); // The hash function
+    // <0, 0 or >0 as (h, keyID) sorts before, with or after node x.
+    inline int compare(uint64_t h, const string &keyID, uint32_t x) {
+      if (h != pool[x].hash) return (h < pool[x].hash) ? -1 : 1;
+      return keyID.compare(cold[x].keyID);
+    }
     // These are helper functions just like in your lab...
-    inline int height(node *x) { return (x==NULL) ? -1 : x->height; }
-    bool update_height(node *x);
-    void rotate_left(node *&a);
-    void rotate_right(node *&b);
-
-    // You may add additional helper functions and member variables...
+    inline int height(uint32_t x) { return pool[x].height; }
+    bool update_height(uint32_t x);
+    void rotate_left(uint32_t &a);
+    void rotate_right(uint32_t &b);
+    void rebalance(uint32_t &x); // Restores the AVL property at x
+    void retrace(); // Fixes heights and balance back up add()'s path
   };
 
 #endif
-
@@ -0,0 +1,127 @@
+#ifndef _ADAPTIVEDICT_CPP
+#define _ADAPTIVEDICT_CPP
+
+//AdaptiveDict.cpp
+#include "AdaptiveDict.hpp"
+#include "KeyHash.hpp"
+#include <cassert>
+#include <cstdlib>//for NULL
+#include <iostream>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// A dictionary that is a small array until it outgrows it.
+//
+
+AdaptiveDict::AdaptiveDict() {
+  number = 0;
+  big = NULL;
+  // search() reads hashes four at a time, past 'number'.
+  for (int i=0; i<SMALL; i++) hashes[i] = 0;
+}
+
+AdaptiveDict::~AdaptiveDict() {
+  if (big!=NULL) {
+    delete big; // which prints its own statistics
+    return;
+  }
+  for (int i=0; i<number; i++) {
+    delete keys[i];
+    // Don't delete data here, to avoid double deletions.
+  }
+
+  // It's not good style to put this into a destructor,
+  // but it's convenient for this assignment...
+  cout << "Never promoted:  " << number << " keys\n";
+}
+
+uint32_t AdaptiveDict::hash(const string &keyID) {
+  // The same hash LinearHashDict uses, so promote() can hand it over.
+  return (uint32_t)(FNVHash::hash(keyID) >> 32);
+}
+
+int AdaptiveDict::search(uint32_t h, const string &keyID) {
+  // Slots past 'number' hold stale hashes; matches there are ignored.
+#if defined(__SSE2__)
+  __m128i want = _mm_set1_epi32((int)h);
+  for (int i=0; i<number; i+=4) {
+    __m128i got = _mm_load_si128((const __m128i *)&hashes[i]);
+    int hits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(got, want)));
+    for (; hits!=0; hits &= hits-1) {
+      int j = i + __builtin_ctz((unsigned)hits);
+      if (j < number && keyIDs[j]==keyID) return j;
+    }
+  }
+#else
+  for (int i=0; i<number; i++) {
+    if (hashes[i]==h && keyIDs[i]==keyID) return i;
+  }
+#endif
+  return -1;
+}
+
+void AdaptiveDict::promote() {
+  big = new LinearHashDict();
+  // The keyIDs and hashes move across; nothing is worked out again.
+  for (int i=0; i<number; i++) big->add(keys[i], data[i], keyIDs[i], hashes[i]);
+  number = 0;
+}
+
+bool AdaptiveDict::find(PuzzleState *key, PuzzleState *&pred) {
+  if (big!=NULL) return big->find(key, pred);
+  string keyID = key->getUniqId();
+  int i = search(hash(keyID), keyID);
+  if (i < 0) return false;
+  pred = data[i];
+  return true;
+}
+
+// You may assume that no duplicate PuzzleState is ever added.
+void AdaptiveDict::add(PuzzleState *key, PuzzleState *pred) {
+  if (big==NULL && number==SMALL) promote();
+  if (big!=NULL) {
+    big->add(key, pred);
+    return;
+  }
+  keyIDs[number] = key->getUniqId();
+  hashes[number] = hash(keyIDs[number]);
+  keys[number] = key;
+  data[number] = pred;
+  number++;
+}
+
+bool AdaptiveDict::find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred) {
+  if (big!=NULL) return big->find_or_add(key, pred, found_pred);
+  string keyID = key->getUniqId();
+  uint32_t h = hash(keyID);
+  int i = search(h, keyID);
+  if (i >= 0) {
+    found_pred = data[i];
+    return true;
+  }
+  if (number==SMALL) {
+    promote();
+    big->add(key, pred, keyID, h);
+    return false;
+  }
+  keyIDs[number].swap(keyID);
+  hashes[number] = h;
+  keys[number] = key;
+  data[number] = pred;
+  number++;
+  return false;
+}
+
+void AdaptiveDict::find_or_add_batch(int n, PuzzleState *offered[], PuzzleState *preds[],
+                                     bool found[], PuzzleState *found_preds[]) {
+  if (big!=NULL) {
+    big->find_or_add_batch(n, offered, preds, found, found_preds);
+    return;
+  }
+  // The arrays are already in cache:  nothing to fetch ahead.
+  for (int i=0; i<n; i++) found[i] = find_or_add(offered[i], preds[i], found_preds[i]);
+}
+
+#endif
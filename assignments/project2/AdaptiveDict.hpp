@@ -0,0 +1,49 @@
+//AdaptiveDict.hpp
+#ifndef _ADAPTIVEDICT_HPP
+#define _ADAPTIVEDICT_HPP
+
+#include "PredDict.hpp"
+#include "LinearHashDict.hpp"
+#include <stdint.h>
+
+// A dictionary for searches of any size, that costs next to nothing
+// for small ones.
+//
+// The first SMALL keys go in arrays inside the object itself:  nothing
+// is allocated (beyond long keyIDs), and a lookup compares the key's
+// 32-bit hash with four stored hashes at a time (SSE2), then checks
+// the keyID of any that match.  The key after that promotes the
+// dictionary:  everything moves into a LinearHashDict, and from then
+// on every call goes straight to it.
+//
+class AdaptiveDict : public PredDict
+  {
+  public:
+    AdaptiveDict();
+    ~AdaptiveDict();
+    bool find(PuzzleState *key, PuzzleState *&pred);
+    void add(PuzzleState *key, PuzzleState *pred);
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred);
+    void find_or_add_batch(int n, PuzzleState *offered[], PuzzleState *preds[],
+                           bool found[], PuzzleState *found_preds[]);
+
+    bool promoted() { return big!=NULL; } // has it become a hash table?
+
+  private:
+    const static int SMALL = 32; // keys held before promotion
+
+    alignas(16) uint32_t hashes[SMALL]; // hashes[i] goes with keys[i]
+    PuzzleState *keys[SMALL];
+    string keyIDs[SMALL]; // Avoid recomputation of key's getUniqId()
+    PuzzleState *data[SMALL];
+    int number; // how many keys are in the arrays
+
+    LinearHashDict *big; // NULL until promoted
+
+    uint32_t hash(const string &keyID); // The hash function
+    // Which of the first 'number' keys has this hash and keyID, or -1.
+    int search(uint32_t h, const string &keyID);
+    void promote(); // Moves every key into a new LinearHashDict
+  };
+
+#endif
@@ -0,0 +1,420 @@
+#ifndef _BTREEDICT_CPP
+#define _BTREEDICT_CPP
+
+//BTreeDict.cpp
+#include "BTreeDict.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>//for NULL
+#include <cstring>
+#include <iostream>
+
+// An implementation of a dictionary ADT as a B+-tree.
+//
+
+static_assert(sizeof(uint64_t) * 14 + sizeof(uint32_t) * 16 <= 192, "leaf outgrew 3 cache lines");
+
+BTreeDict::BTreeDict() {
+  root = NONE;
+  height = 0;
+
+  // Initialize array of counters for compare statistics
+  compare_stats = new int[MAX_STATS]();
+}
+
+BTreeDict::~BTreeDict() {
+  for (size_t i=0; i<entries.size(); i++) {
+    delete entries[i].key;
+    // Don't delete data here, to avoid double deletions.
+  }
+
+  // It's not good style to put this into a destructor,
+  // but it's convenient for this assignment...
+  cout << "KeyID Compare Statistics for find():\n";
+  for (int i=0; i<MAX_STATS; i++)
+    cout << i << ": " << compare_stats[i] << endl;
+  cout << "Height: " << height << ", leaves: " << leaves.size()
+       << ", inner nodes: " << inners.size() << endl;
+  delete [] compare_stats;
+}
+
+uint64_t BTreeDict::prefix(const string &keyID, int skip) {
+  // Big-endian, zero-padded:  compares like the 8 bytes themselves.
+  uint64_t p = 0;
+  size_t at = (size_t)skip;
+  if (at + 8 <= keyID.length()) {
+    memcpy(&p, keyID.data() + at, 8);
+    return __builtin_bswap64(p);
+  }
+  for (size_t i=at; i<at+8; i++) {
+    p = (p << 8) | ((i < keyID.length()) ? (unsigned char)keyID[i] : 0u);
+  }
+  return p;
+}
+
+int BTreeDict::common(uint32_t a, uint32_t b) {
+  if (a==NONE || b==NONE) return 0;
+  const string &x = entries[a].keyID;
+  const string &y = entries[b].keyID;
+  size_t i = 0;
+  while (i < x.length() && i < y.length() && x[i]==y[i] && i < 0xffff) i++;
+  return (int)i;
+}
+
+void BTreeDict::set_skip(leaf &l, int skip) {
+  l.skip = (uint16_t)skip;
+  for (int j=0; j<l.count; j++) l.prefix[j] = prefix(entries[l.entry[j]].keyID, skip);
+}
+
+void BTreeDict::set_skip(inner &n, int skip) {
+  n.skip = (uint16_t)skip;
+  for (int j=0; j<n.count; j++) n.prefix[j] = prefix(entries[n.entry[j]].keyID, skip);
+}
+
+template <int WIDTH>
+int BTreeDict::rank(const uint64_t *prefixes, const uint32_t *ids, int n, uint64_t p,
+                    const string &keyID, bool or_equal, int &compares) {
+  // Count over every slot, used or not, so the loop has a fixed
+  // length and no branches; unused slots hold UINT64_MAX.
+  int lo = 0, hi = 0;
+  for (int i=0; i<WIDTH; i++) {
+    lo += (prefixes[i] < p);
+    hi += (prefixes[i] <= p);
+  }
+  if (hi > n) hi = n;
+  // Keys lo..hi-1 share our prefix; they're in order, so step over the
+  // ones that come first.
+  while (lo < hi) {
+    compares++;
+    int c = keyID.compare(entries[ids[lo]].keyID);
+    if (c < 0 || (c==0 && !or_equal)) break;
+    lo++;
+  }
+  return lo;
+}
+
+uint32_t BTreeDict::new_leaf() {
+  leaf l;
+  for (int i=0; i<LEAF_KEYS; i++) {
+    l.prefix[i] = UINT64_MAX;
+    l.entry[i] = NONE;
+  }
+  l.next = NONE;
+  l.count = 0;
+  l.skip = 0;
+  leaves.push_back(l);
+  return (uint32_t)(leaves.size()-1);
+}
+
+uint32_t BTreeDict::new_inner() {
+  inner n;
+  for (int i=0; i<INNER_KEYS; i++) {
+    n.prefix[i] = UINT64_MAX;
+    n.entry[i] = NONE;
+    n.child[i] = NONE;
+  }
+  n.child[INNER_KEYS] = NONE;
+  n.count = 0;
+  n.skip = 0;
+  inners.push_back(n);
+  return (uint32_t)(inners.size()-1);
+}
+
+bool BTreeDict::find(PuzzleState *key, PuzzleState *&pred) {
+  if (root==NONE) return false;
+  string keyID = key->getUniqId();
+  int compares = 0;
+  uint32_t x = root;
+  for (int level=height; level>0; level--) {
+    inner &n = inners[x];
+    uint64_t p = prefix(keyID, n.skip);
+    x = n.child[rank<INNER_KEYS>(n.prefix, n.entry, n.count, p, keyID, true, compares)];
+  }
+  leaf &l = leaves[x];
+  uint64_t p = prefix(keyID, l.skip);
+  int i = rank<LEAF_KEYS>(l.prefix, l.entry, l.count, p, keyID, false, compares);
+  bool found = false;
+  if (i < l.count && l.prefix[i]==p) {
+    // rank() stopped at the first keyID not less than ours; it may
+    // have already compared it.
+    compares++;
+    found = (entries[l.entry[i]].keyID==keyID);
+    if (found) pred = entries[l.entry[i]].data;
+  }
+  compare_stats[(compares < MAX_STATS) ? compares : MAX_STATS-1]++;
+  return found;
+}
+
+// You may assume that no duplicate PuzzleState is ever added.
+void BTreeDict::add(PuzzleState *key, PuzzleState *pred) {
+  string keyID = key->getUniqId();
+  PuzzleState *ignored;
+  put(key, pred, keyID, false, ignored);
+}
+
+bool BTreeDict::find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred) {
+  string keyID = key->getUniqId();
+  return put(key, pred, keyID, true, found_pred);
+}
+
+bool BTreeDict::put(PuzzleState *key, PuzzleState *pred, string &keyID, bool check,
+                    PuzzleState *&found_pred) {
+  if (root==NONE) {
+    root = new_leaf();
+    height = 0;
+  }
+
+  // Walk down, remembering the way.
+  int compares = 0;
+  path.clear();
+  slots.clear();
+  lows.clear();
+  highs.clear();
+  uint32_t x = root, low = NONE, high = NONE;
+  for (int level=height; level>0; level--) {
+    inner &n = inners[x];
+    uint64_t p = prefix(keyID, n.skip);
+    int i = rank<INNER_KEYS>(n.prefix, n.entry, n.count, p, keyID, true, compares);
+    path.push_back(x);
+    slots.push_back(i);
+    lows.push_back(low);
+    highs.push_back(high);
+    if (i > 0) low = n.entry[i-1];
+    if (i < n.count) high = n.entry[i];
+    x = n.child[i];
+  }
+
+  // Put the key in its leaf, as if the leaf had room for one more.
+  uint64_t prefixes[LEAF_KEYS+1];
+  uint32_t ids[LEAF_KEYS+1];
+  {
+    leaf &l = leaves[x];
+    uint64_t p = prefix(keyID, l.skip);
+    int i = rank<LEAF_KEYS>(l.prefix, l.entry, l.count, p, keyID, false, compares);
+    if (check) {
+      bool found = false;
+      if (i < l.count && l.prefix[i]==p) {
+        compares++;
+        found = (entries[l.entry[i]].keyID==keyID);
+      }
+      compare_stats[(compares < MAX_STATS) ? compares : MAX_STATS-1]++;
+      if (found) {
+        found_pred = entries[l.entry[i]].data;
+        return true;
+      }
+    }
+
+    uint32_t e = (uint32_t)entries.size();
+    entries.push_back(entry());
+    entries[e].key = key;
+    entries[e].keyID.swap(keyID);
+    entries[e].data = pred;
+    for (int j=0; j<i; j++) { prefixes[j] = l.prefix[j]; ids[j] = l.entry[j]; }
+    prefixes[i] = p;
+    ids[i] = e;
+    for (int j=i; j<l.count; j++) { prefixes[j+1] = l.prefix[j]; ids[j+1] = l.entry[j]; }
+    if (l.count < LEAF_KEYS) {
+      l.count++;
+      for (int j=0; j<l.count; j++) { l.prefix[j] = prefixes[j]; l.entry[j] = ids[j]; }
+      return false;
+    }
+  }
+
+  // Full:  split it, keeping the lower half here.
+  uint32_t right = new_leaf();
+  leaf &l = leaves[x];
+  leaf &r = leaves[right];
+  int keep = (LEAF_KEYS+1) / 2;
+  l.count = (uint16_t)keep;
+  r.count = (uint16_t)(LEAF_KEYS+1 - keep);
+  for (int j=0; j<LEAF_KEYS; j++) {
+    l.prefix[j] = (j < keep) ? prefixes[j] : UINT64_MAX;
+    l.entry[j] = (j < keep) ? ids[j] : NONE;
+  }
+  for (int j=0; j<r.count; j++) {
+    r.prefix[j] = prefixes[keep+j];
+    r.entry[j] = ids[keep+j];
+  }
+  r.next = l.next;
+  l.next = right;
+  // Both halves now have a tighter range, so maybe more to skip.
+  uint32_t split = r.entry[0];
+  set_skip(l, common(low, split));
+  set_skip(r, common(split, high));
+  insert_separator((int)path.size()-1, split, right);
+  return false;
+}
+
+void BTreeDict::insert_separator(int level, uint32_t e, uint32_t right) {
+  if (level < 0) {
+    // We split the root:  grow a new one above it.
+    uint32_t top = new_inner();
+    inner &n = inners[top];
+    n.count = 1;
+    n.prefix[0] = prefix(entries[e].keyID, 0);
+    n.entry[0] = e;
+    n.child[0] = root;
+    n.child[1] = right;
+    root = top;
+    height++;
+    return;
+  }
+
+  uint32_t x = path[level];
+  int i = slots[level]; // the child that split; the new one goes after it
+  uint64_t prefixes[INNER_KEYS+1];
+  uint32_t ids[INNER_KEYS+1];
+  uint32_t children[INNER_KEYS+2];
+  {
+    inner &n = inners[x];
+    for (int j=0; j<i; j++) { prefixes[j] = n.prefix[j]; ids[j] = n.entry[j]; }
+    prefixes[i] = prefix(entries[e].keyID, n.skip);
+    ids[i] = e;
+    for (int j=i; j<n.count; j++) { prefixes[j+1] = n.prefix[j]; ids[j+1] = n.entry[j]; }
+    for (int j=0; j<=i; j++) children[j] = n.child[j];
+    children[i+1] = right;
+    for (int j=i+1; j<=n.count; j++) children[j+1] = n.child[j];
+    if (n.count < INNER_KEYS) {
+      n.count++;
+      for (int j=0; j<n.count; j++) { n.prefix[j] = prefixes[j]; n.entry[j] = ids[j]; }
+      for (int j=0; j<=n.count; j++) n.child[j] = children[j];
+      return;
+    }
+  }
+
+  // Full:  the middle separator moves up, and the ones after it (with
+  // their children) go to a new node.
+  uint32_t sibling = new_inner();
+  inner &n = inners[x];
+  inner &s = inners[sibling];
+  int keep = (INNER_KEYS+1) / 2;
+  n.count = (uint16_t)keep;
+  s.count = (uint16_t)(INNER_KEYS - keep);
+  for (int j=0; j<INNER_KEYS; j++) {
+    n.prefix[j] = (j < keep) ? prefixes[j] : UINT64_MAX;
+    n.entry[j] = (j < keep) ? ids[j] : NONE;
+  }
+  for (int j=0; j<=INNER_KEYS; j++) n.child[j] = (j <= keep) ? children[j] : NONE;
+  for (int j=0; j<s.count; j++) {
+    s.prefix[j] = prefixes[keep+1+j];
+    s.entry[j] = ids[keep+1+j];
+  }
+  for (int j=0; j<=s.count; j++) s.child[j] = children[keep+1+j];
+  uint32_t split = ids[keep];
+  set_skip(n, common(lows[level], split));
+  set_skip(s, common(split, highs[level]));
+  insert_separator(level-1, split, sibling);
+}
+
+namespace {
+  // Orders entry numbers by (prefix, keyID).
+  struct by_key {
+    const vector<uint64_t> *prefixes;
+    const vector<string> *ids;
+    bool operator()(uint32_t a, uint32_t b) const {
+      if ((*prefixes)[a] != (*prefixes)[b]) return (*prefixes)[a] < (*prefixes)[b];
+      return (*ids)[a] < (*ids)[b];
+    }
+  };
+}
+
+void BTreeDict::bulk_load(const vector<PuzzleState*> &keys, const vector<PuzzleState*> &preds) {
+  if (root!=NONE) {
+    cerr << "BTreeDict::bulk_load:  not empty; adding one at a time" << endl;
+    for (size_t i=0; i<keys.size(); i++) add(keys[i], preds[i]);
+    return;
+  }
+  if (keys.empty()) return;
+
+  // Sort the keys.
+  size_t n = keys.size();
+  vector<string> ids(n);
+  vector<uint64_t> prefixes(n);
+  vector<uint32_t> order(n);
+  for (size_t i=0; i<n; i++) {
+    ids[i] = keys[i]->getUniqId();
+    prefixes[i] = prefix(ids[i], 0);
+    order[i] = (uint32_t)i;
+  }
+  by_key less;
+  less.prefixes = &prefixes;
+  less.ids = &ids;
+  sort(order.begin(), order.end(), less);
+
+  entries.resize(n);
+  for (size_t i=0; i<n; i++) {
+    entries[i].key = keys[order[i]];
+    entries[i].keyID.swap(ids[order[i]]);
+    entries[i].data = preds[order[i]];
+  }
+
+  // Full leaves, except that the keys are spread evenly, so none ends
+  // up nearly empty.  'level' is the nodes of one level, with the
+  // first key under each; each node is bounded by its own first key
+  // and the next node's (none for the ends).
+  size_t groups = (n + LEAF_KEYS-1) / LEAF_KEYS;
+  vector<uint32_t> level;
+  vector<uint32_t> firsts;
+  size_t next = 0;
+  for (size_t g=0; g<groups; g++) {
+    size_t take = n / groups + (g < n % groups ? 1 : 0);
+    uint32_t x = new_leaf();
+    leaf &l = leaves[x];
+    for (size_t j=0; j<take; j++, next++) l.entry[j] = (uint32_t)next;
+    l.count = (uint16_t)take;
+    set_skip(l, common((g > 0) ? l.entry[0] : NONE, (g+1 < groups) ? (uint32_t)next : NONE));
+    if (x > 0) leaves[x-1].next = x;
+    level.push_back(x);
+    firsts.push_back(l.entry[0]);
+  }
+
+  // Each level up gets a node per INNER_KEYS+1 children, again spread
+  // evenly.  A node's separators are the first keys of its children
+  // (after the first).
+  height = 0;
+  while (level.size() > 1) {
+    size_t c = level.size();
+    groups = (c + INNER_KEYS) / (INNER_KEYS+1);
+    vector<uint32_t> up, up_firsts;
+    next = 0;
+    for (size_t g=0; g<groups; g++) {
+      size_t take = c / groups + (g < c % groups ? 1 : 0);
+      uint32_t x = new_inner();
+      inner &m = inners[x];
+      for (size_t j=0; j<take; j++, next++) {
+        m.child[j] = level[next];
+        if (j > 0) m.entry[j-1] = firsts[next];
+      }
+      m.count = (uint16_t)(take - 1);
+      set_skip(m, common((g > 0) ? firsts[next-take] : NONE,
+                         (g+1 < groups) ? firsts[next] : NONE));
+      up.push_back(x);
+      up_firsts.push_back(firsts[next-take]);
+    }
+    level.swap(up);
+    firsts.swap(up_firsts);
+    height++;
+  }
+  root = level[0];
+}
+
+void BTreeDict::for_each(void (*visit)(PuzzleState *key, PuzzleState *pred, void *arg), void *arg) {
+  if (root==NONE) return;
+  // Leaf 0 is always the leftmost:  splits only add leaves to the right.
+  for (uint32_t x=0; x!=NONE; x=leaves[x].next) {
+    for (int i=0; i<leaves[x].count; i++) {
+      entry &e = entries[leaves[x].entry[i]];
+      visit(e.key, e.data, arg);
+    }
+  }
+}
+
+static void print_one(PuzzleState *key, PuzzleState *, void *arg) {
+  key->print(*(ostream *)arg);
+}
+
+void BTreeDict::print_sorted(ostream &out) {
+  for_each(print_one, &out);
+}
+
+#endif
@@ -0,0 +1,119 @@
+//BTreeDict.hpp
+#ifndef _BTREEDICT_HPP
+#define _BTREEDICT_HPP
+
+#include "PredDict.hpp"
+#include <stdint.h>
+#include <vector>
+
+// An implementation of a dictionary ADT as a B+-tree.
+//
+// Every key is in a leaf; inner nodes only hold separators to steer
+// searches.  Nodes are a few cache lines each (leaves 192 bytes, inner
+// nodes 256) and hold up to 14 keys or 12 separators, so a lookup in
+// 10M keys visits 7 or so nodes instead of AVLDict's 25-odd.
+//
+// Keys are ordered by their keyID.  A node stores 8 bytes of each
+// keyID as a big-endian 64-bit "prefix", which sorts the same way, so
+// a node is searched by counting how many prefixes are smaller (a loop
+// with no branches, which the compiler vectorizes).  The full keyID,
+// kept with the key in a separate entry array, is only looked at when
+// prefixes tie.  Ties would be common deep in the tree, where keys
+// share their first bytes, so each node skips the bytes that every key
+// under it has in common (what its two bounding separators share), and
+// takes its 8 bytes from there.
+//
+// Leaves are chained left to right, so the keys can be visited in
+// sorted order.
+//
+class BTreeDict : public PredDict
+  {
+  public:
+    BTreeDict();
+    ~BTreeDict();
+    bool find(PuzzleState *key, PuzzleState *&pred);
+    void add(PuzzleState *key, PuzzleState *pred);
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred);
+
+    // Builds the tree from scratch, much faster than adding keys one
+    // at a time:  sorts them, then packs full leaves and builds each
+    // level above from the one below.  keys[i]'s predecessor is
+    // preds[i].  The dictionary must be empty, and keys distinct.
+    void bulk_load(const vector<PuzzleState*> &keys, const vector<PuzzleState*> &preds);
+
+    // Calls visit(key, pred, arg) for every key, in keyID order.
+    void for_each(void (*visit)(PuzzleState *key, PuzzleState *pred, void *arg), void *arg);
+    // Prints every key, in keyID order.
+    void print_sorted(ostream &out);
+
+    int count() { return (int)entries.size(); } // how many keys are stored
+    int get_height() { return height; } // levels above the leaves
+
+  private:
+    const static int LEAF_KEYS = 14;
+    const static int INNER_KEYS = 12;
+    const static uint32_t NONE = 0xffffffffu;
+
+    struct alignas(64) leaf {
+      uint64_t prefix[LEAF_KEYS]; // unused slots hold UINT64_MAX
+      uint32_t entry[LEAF_KEYS];
+      uint32_t next; // the leaf to the right, or NONE
+      uint16_t count;
+      uint16_t skip; // keyID bytes shared by every key that can be here
+    };
+
+    // child[i] holds the keys between separators i-1 and i.
+    struct alignas(64) inner {
+      uint64_t prefix[INNER_KEYS]; // unused slots hold UINT64_MAX
+      uint32_t entry[INNER_KEYS]; // the separator keys
+      uint32_t child[INNER_KEYS+1];
+      uint16_t count; // separators; there's one more child
+      uint16_t skip; // keyID bytes shared by every key that can be below
+    };
+
+    struct entry {
+      PuzzleState *key;
+      string keyID; // Avoid recomputation of key's getUniqId()
+      PuzzleState *data;
+    };
+
+    vector<leaf> leaves;
+    vector<inner> inners;
+    vector<entry> entries;
+    uint32_t root; // a leaf if height is 0, else an inner node
+    int height;
+    vector<uint32_t> path; // add()'s inner nodes from the root down
+    vector<int> slots; // ... which child it took in each
+    vector<uint32_t> lows, highs; // ... and their bounding separators
+
+    // The next two variables are just to collect statistics on the
+    // number of keyID compares needed for each call to find().
+    int *compare_stats; // compare_stats[i] is how often find() needed i
+    const static int MAX_STATS = 20; // How big to make the array.
+
+    // keyID's 8 bytes from 'skip' on, as a number.
+    static uint64_t prefix(const string &keyID, int skip);
+    // How many bytes the keyIDs of entries a and b share; 0 if either
+    // is NONE (no bound).
+    int common(uint32_t a, uint32_t b);
+    void set_skip(leaf &l, int skip);
+    void set_skip(inner &n, int skip);
+    // How many of the n sorted keys (prefix[i], entry[i]) come before
+    // (p, keyID), or with or_equal, not after it.  compares counts
+    // the keyIDs looked at.
+    template <int WIDTH>
+    int rank(const uint64_t *prefixes, const uint32_t *ids, int n, uint64_t p,
+             const string &keyID, bool or_equal, int &compares);
+    // add(), and with check, find_or_add():  walks down once, and
+    // puts the key in its leaf unless it's already there.  keyID is
+    // taken over.
+    bool put(PuzzleState *key, PuzzleState *pred, string &keyID, bool check,
+             PuzzleState *&found_pred);
+    uint32_t new_leaf();
+    uint32_t new_inner();
+    // Puts separator e with right-hand child 'right' into the inner
+    // node at path level 'level', splitting upwards as needed.
+    void insert_separator(int level, uint32_t e, uint32_t right);
+  };
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef _BENCHKEYS_CPP
+#define _BENCHKEYS_CPP
+
+//BenchKeys.cpp
+#include "BenchKeys.hpp"
+#include <cstdlib>
+#include <set>
+#include <sstream>
+
+vector<string> make_slider_keys(int n, int rows, int cols, unsigned seed) {
+  srand(seed);
+  vector<int> board(rows*cols);
+  for (int i=0; i<rows*cols; i++) board[i] = i;
+
+  set<string> seen;
+  vector<string> keys;
+  while ((int)keys.size() < n) {
+    // A fresh shuffle of the tiles.
+    for (int i=rows*cols-1; i>0; i--) {
+      int j = rand() % (i+1);
+      int t = board[i]; board[i] = board[j]; board[j] = t;
+    }
+    ostringstream id;
+    for (int i=0; i<rows; i++) {
+      for (int j=0; j<cols; j++) id << "\t" << board[i*cols+j];
+      id << endl;
+    }
+    if (seen.insert(id.str()).second) keys.push_back(id.str());
+  }
+  return keys;
+}
+
+vector<string> make_maze_keys(int n) {
+  int side = 1;
+  while (side*side < n) side++;
+  vector<string> keys;
+  for (int i=0; i<n; i++) {
+    ostringstream id;
+    id << i/side << "," << i%side;
+    keys.push_back(id.str());
+  }
+  return keys;
+}
+
+vector<string> make_river_keys(int n) {
+  vector<string> keys;
+  for (int i=0; i<n; i++) {
+    string key(4, '\0');
+    for (int b=0; b<4; b++) key[b] = (char)((unsigned)i >> (8*b));
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+vector<string> make_sudoku_keys(int n, unsigned seed) {
+  srand(seed);
+  const int CELLS = 81;
+  vector<int> given(CELLS, 0);
+  for (int k=0; k<30; k++) given[rand() % CELLS] = 1 + rand() % 9;
+
+  set<string> seen;
+  vector<string> keys;
+  vector<int> grid(CELLS);
+  while ((int)keys.size() < n) {
+    grid = given;
+    for (int k=0; k<6; k++) {
+      int i = rand() % CELLS;
+      if (grid[i]==0) grid[i] = 1 + rand() % 9;
+    }
+    string key((CELLS*4 + 7)/8, '\0');
+    for (int i=0; i<CELLS; i++) {
+      key[i/2] = (char)(key[i/2] | (grid[i] << (4*(i%2))));
+    }
+    if (seen.insert(key).second) keys.push_back(key);
+  }
+  return keys;
+}
+
+#endif
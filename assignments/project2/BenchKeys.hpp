@@ -0,0 +1,43 @@
+//BenchKeys.hpp
+#ifndef _BENCHKEYS_HPP
+#define _BENCHKEYS_HPP
+
+#include "PuzzleState.hpp"
+#include <string>
+#include <vector>
+
+// Keys for the dictionary benchmarks.
+//
+// A KeyState is a PuzzleState that is nothing but its getUniqId(), so a
+// benchmark can fill a dictionary with realistic keys without running a
+// search.  It has no successors and is never a solution.
+class KeyState : public PuzzleState {
+ public:
+  KeyState(const string &id) : keyID(id) { }
+  bool isSolution() { return false; }
+  vector<PuzzleState*> getSuccessors() { return vector<PuzzleState*>(); }
+  int getBadness() { return 0; }
+  string getUniqId() { return keyID; }
+  void print(ostream &out) { out << keyID << endl; }
+ private:
+  string keyID;
+};
+
+// Returns n distinct ids shaped like those of a rows x cols SliderPuzzle
+// (random boards, printed the way SliderPuzzle::getUniqId prints them).
+// The same seed gives the same keys.
+vector<string> make_slider_keys(int n, int rows, int cols, unsigned seed);
+
+// Ids shaped like those of project 1's other puzzles, for hashquality.
+//
+// The first n squares of a square MazeRunner maze, in row-major order,
+// as "row,col".
+vector<string> make_maze_keys(int n);
+// RiverCrossing states 0..n-1, as their 4 little-endian bytes.
+vector<string> make_river_keys(int n);
+// n distinct 9x9 Sudoku grids, packed 4 bits to a square the way
+// BasicSudoku<3>::getUniqId packs them:  one random puzzle with 30
+// squares given, and n ways of filling in a few more.
+vector<string> make_sudoku_keys(int n, unsigned seed);
+
+#endif
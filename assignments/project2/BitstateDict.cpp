@@ -0,0 +1,130 @@
+#ifndef _BITSTATEDICT_CPP
+#define _BITSTATEDICT_CPP
+
+//BitstateDict.cpp
+#include "BitstateDict.hpp"
+#include "KeyHash.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstdlib>//for NULL
+#include <iostream>
+
+// An approximate dictionary of seen states, as k bits per state.
+//
+
+BitstateDict::BitstateDict(int log2_bits, int hashes) {
+  if (log2_bits < 6) log2_bits = 6;
+  if (log2_bits > 40) log2_bits = 40;
+  bits.assign((size_t)1 << (log2_bits - 6), 0);
+  mask = ((uint64_t)1 << log2_bits) - 1;
+  this->hashes = (hashes < 1) ? 1 : hashes;
+  added = 0;
+  bits_set = 0;
+}
+
+BitstateDict::~BitstateDict() {
+  // It's not good style to put this into a destructor,
+  // but it's convenient for this assignment...
+  cout << "Bitstate Statistics:\n";
+  cout << "Bits: " << mask+1 << ", hashes per state: " << hashes << endl;
+  cout << "Bits set: " << bits_set << " (" << fill() << " full)" << endl;
+  cout << "States added: " << added << ", estimated distinct: " << (long)estimated_states() << endl;
+  cout << "Omission probability: " << omission_probability() << endl;
+}
+
+uint64_t BitstateDict::hash(const string &keyID) {
+  // Both halves depend on every character.
+  return FNVHash::hash(keyID);
+}
+
+// Bit i of a state is h1 + i*h2, where h2 is odd so the k bits differ
+// for any table size.
+bool BitstateDict::find(PuzzleState *key, PuzzleState *&pred) {
+  string keyID = key->getUniqId();
+  uint64_t first = hash(keyID);
+  uint64_t h = first;
+  uint64_t step = ((h >> 32) | (h << 32)) | 1;
+  for (int i=0; i<hashes; i++, h+=step) {
+    uint64_t b = h & mask;
+    if (!(bits[b >> 6] & ((uint64_t)1 << (b & 63)))) return false;
+  }
+
+  // Seen, or so it seems.
+  pred = path_pred(first, keyID);
+  return true;
+}
+
+PuzzleState *BitstateDict::path_pred(uint64_t h, const string &keyID) {
+  // Only states on the path know their predecessor.
+  unordered_map<uint64_t, size_t>::iterator on_path = path_index.find(h);
+  if (on_path == path_index.end()) return NULL;
+  size_t i = on_path->second;
+  return (i > 0 && path[i].keyID==keyID) ? path[i-1].key : NULL;
+}
+
+// Predecessors aren't kept; see push_path().
+void BitstateDict::add(PuzzleState *key, PuzzleState *) {
+  uint64_t h = hash(key->getUniqId());
+  uint64_t step = ((h >> 32) | (h << 32)) | 1;
+  for (int i=0; i<hashes; i++, h+=step) {
+    uint64_t b = h & mask;
+    uint64_t bit = (uint64_t)1 << (b & 63);
+    bits_set += !(bits[b >> 6] & bit);
+    bits[b >> 6] |= bit;
+  }
+  added++;
+}
+
+bool BitstateDict::find_or_add(PuzzleState *key, PuzzleState *, PuzzleState *&found_pred) {
+  string keyID = key->getUniqId();
+  uint64_t first = hash(keyID);
+  uint64_t h = first;
+  uint64_t step = ((h >> 32) | (h << 32)) | 1;
+  int fresh = 0;
+  for (int i=0; i<hashes; i++, h+=step) {
+    uint64_t b = h & mask;
+    uint64_t bit = (uint64_t)1 << (b & 63);
+    fresh += !(bits[b >> 6] & bit);
+    bits[b >> 6] |= bit;
+  }
+  if (fresh==0) {
+    found_pred = path_pred(first, keyID);
+    return true;
+  }
+  bits_set += fresh;
+  added++;
+  return false;
+}
+
+void BitstateDict::push_path(PuzzleState *key) {
+  path_entry e;
+  e.keyID = key->getUniqId();
+  e.hash = hash(e.keyID);
+  e.key = key;
+  path_index[e.hash] = path.size();
+  path.push_back(e);
+}
+
+void BitstateDict::pop_path() {
+  assert(!path.empty());
+  path_index.erase(path.back().hash);
+  path.pop_back();
+}
+
+double BitstateDict::fill() {
+  return (double)bits_set / ((double)mask + 1.0);
+}
+
+double BitstateDict::omission_probability() {
+  return pow(fill(), hashes);
+}
+
+double BitstateDict::estimated_states() {
+  // Each distinct state sets k bits at random, so after n of them a
+  // bit is still clear with probability (1-1/m)^(kn) ~ e^(-kn/m).
+  double f = fill();
+  if (f >= 1.0) return INFINITY;
+  return -((double)mask + 1.0) / hashes * log(1.0 - f);
+}
+
+#endif
@@ -0,0 +1,70 @@
+//BitstateDict.hpp
+#ifndef _BITSTATEDICT_HPP
+#define _BITSTATEDICT_HPP
+
+#include "PredDict.hpp"
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+// An approximate dictionary for state spaces too big to store:
+// "bitstate hashing", or supertrace.
+//
+// Nothing is kept per state.  add() sets k bits of one big, fixed size
+// bit array, picked by the key's hash (double hashing, as in a Bloom
+// filter), and find() says yes if all k are set.  So find() can
+// wrongly say yes to a state that was never added, two states' bits
+// having happened to cover it; that state then goes unexplored.
+// It never wrongly says no.  The chance of a wrong yes grows with the
+// fraction f of bits set:  about f^k.  omission_probability() reports
+// it, and the destructor prints it.
+//
+// Since keys aren't stored, the dictionary doesn't own them either:
+// the caller deletes its states.  There are no predecessors, except
+// that a depth-first search can keep its current path here with
+// push_path() and pop_path(); then find() of a state on the path
+// gives the state before it, so the path to a solution can still be
+// followed back to the start.
+//
+class BitstateDict : public PredDict
+  {
+  public:
+    // 2^log2_bits bits (2^30 is 128MB), and 'hashes' bits per state.
+    BitstateDict(int log2_bits = 30, int hashes = 3);
+    ~BitstateDict();
+    bool find(PuzzleState *key, PuzzleState *&pred);
+    void add(PuzzleState *key, PuzzleState *pred);
+    // Tests and sets the bits in one pass.
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred);
+
+    // The current search path, start first.  key must have been added.
+    void push_path(PuzzleState *key);
+    void pop_path();
+
+    long count() { return added; } // add() calls, counting duplicates
+    double fill(); // fraction of bits set
+    double omission_probability(); // fill()^hashes
+    double estimated_states(); // distinct states, judging by fill()
+
+  private:
+    vector<uint64_t> bits;
+    uint64_t mask; // bit numbers are hash & mask
+    int hashes;
+    long added;
+    long bits_set;
+
+    struct path_entry {
+      uint64_t hash;
+      string keyID;
+      PuzzleState *key;
+    };
+    vector<path_entry> path;
+    unordered_map<uint64_t, size_t> path_index; // hash -> place in path
+
+    uint64_t hash(const string &keyID); // The hash function
+    // The predecessor of the state on the path with this keyID and
+    // hash, or NULL.
+    PuzzleState *path_pred(uint64_t h, const string &keyID);
+  };
+
+#endif
@@ -0,0 +1,222 @@
+#ifndef _CONCURRENTHASHDICT_CPP
+#define _CONCURRENTHASHDICT_CPP
+
+//ConcurrentHashDict.cpp
+#include "ConcurrentHashDict.hpp"
+#include "KeyHash.hpp"
+#include <cassert>
+#include <cstdlib>//for NULL
+#include <iostream>
+
+// An implementation of a dictionary ADT as a lock-free hash table.
+//
+
+ConcurrentHashDict::ConcurrentHashDict() {
+  current.store(make_table(1024));
+  generations.store(1);
+}
+
+ConcurrentHashDict::~ConcurrentHashDict() {
+  // No one else is using the dictionary now.  count() finishes any
+  // copy in progress; then the newest table has every entry once.
+  count();
+  table *t = current.load();
+  for (int i=0; i<t->size; i++) {
+    uint64_t v = t->slots[i].load();
+    if (v!=0) {
+      entry *e = unpack(v);
+      delete e->key;
+      // Don't delete data here, to avoid double deletions.
+      delete e;
+    }
+  }
+  while (t!=NULL) {
+    table *older = t->prev;
+    delete [] t->slots;
+    delete t;
+    t = older;
+  }
+}
+
+uint64_t ConcurrentHashDict::hash(const string &keyID) {
+  // The tag (the top 16 bits) and the slot number both depend on
+  // every character.
+  return FNVHash::hash(keyID);
+}
+
+ConcurrentHashDict::table *ConcurrentHashDict::make_table(int size) {
+  table *t = new table;
+  t->size = size;
+  t->slots = new atomic<uint64_t>[size];
+  for (int i=0; i<size; i++) t->slots[i].store(0, memory_order_relaxed);
+  t->number.store(0);
+  t->next.store(NULL);
+  t->prev = NULL;
+  t->claimed.store(0);
+  t->copied.store(0);
+  return t;
+}
+
+int ConcurrentHashDict::count() {
+  // Finish any copy, so that every key is in the newest table.
+  table *t = current.load();
+  while (t->next.load()!=NULL) {
+    help_copy(t);
+    advance();
+    t = current.load();
+  }
+  return t->number.load();
+}
+
+ConcurrentHashDict::entry *ConcurrentHashDict::lookup(uint64_t h, const string &keyID) {
+  table *t = current.load(memory_order_acquire);
+  while (t!=NULL) {
+    int mask = t->size - 1;
+    int i = (int)(h & (uint64_t)mask);
+    bool moved = false;
+    for (int probes=0; probes<t->size && !moved; probes++) {
+      uint64_t v = t->slots[i].load(memory_order_acquire);
+      if (v==0) return NULL; // Never added.
+      if (holds(v, h, keyID)) return unpack(v);
+      // A frozen slot has been copied, and so has the rest of this
+      // key's run, if it was ever added here; look in the next table.
+      moved = (v & FROZEN)!=0;
+      i = (i+1) & mask;
+    }
+    t = t->next.load(memory_order_acquire);
+  }
+  return NULL;
+}
+
+void ConcurrentHashDict::grow(table *t) {
+  if (t->next.load(memory_order_acquire)!=NULL) return;
+  table *bigger = make_table(2 * t->size);
+  bigger->prev = t;
+  table *expected = NULL;
+  if (t->next.compare_exchange_strong(expected, bigger, memory_order_acq_rel)) {
+    generations++;
+  } else {
+    // Someone else got there first.
+    delete [] bigger->slots;
+    delete bigger;
+  }
+}
+
+bool ConcurrentHashDict::copy_slot(table *t, int i) {
+  uint64_t v = t->slots[i].load(memory_order_acquire);
+  while (true) {
+    if (v & FROZEN) return v==FROZEN;
+    if (v==0) {
+      // Freeze it empty, unless someone adds a key to it first.
+      if (t->slots[i].compare_exchange_weak(v, FROZEN, memory_order_acq_rel)) return true;
+      continue;
+    }
+    // Entries never change, so copy first and then freeze:  readers
+    // sent on by the frozen slot will find the copy.
+    insert(t->next.load(memory_order_acquire), unpack(v));
+    t->slots[i].fetch_or(FROZEN, memory_order_acq_rel);
+    return false;
+  }
+}
+
+void ConcurrentHashDict::advance() {
+  table *t = current.load(memory_order_acquire);
+  while (t->next.load(memory_order_acquire)!=NULL
+         && t->copied.load(memory_order_acquire)==chunks(t)) {
+    current.compare_exchange_strong(t, t->next.load(memory_order_acquire));
+    t = current.load(memory_order_acquire);
+  }
+}
+
+void ConcurrentHashDict::help_copy(table *t) {
+  int n = chunks(t);
+  while (true) {
+    int c = t->claimed.fetch_add(1, memory_order_acq_rel);
+    if (c >= n) return;
+    int end = (c+1)*CHUNK < t->size ? (c+1)*CHUNK : t->size;
+    for (int i=c*CHUNK; i<end; i++) copy_slot(t, i);
+    if (t->copied.fetch_add(1, memory_order_acq_rel)+1 == n) advance();
+  }
+}
+
+void ConcurrentHashDict::freeze_run(table *t, uint64_t h) {
+  if (t->copied.load(memory_order_acquire)==chunks(t)) return; // all done
+  int mask = t->size - 1;
+  int i = (int)(h & (uint64_t)mask);
+  for (int probes=0; probes<t->size; probes++) {
+    if (copy_slot(t, i)) return; // end of the run
+    i = (i+1) & mask;
+  }
+}
+
+ConcurrentHashDict::entry *ConcurrentHashDict::insert(table *t, entry *e) {
+  uint64_t h = e->hash;
+  while (true) {
+    table *next = t->next.load(memory_order_acquire);
+    if (next!=NULL) {
+      // This table is being copied:  lend a hand, make sure the key
+      // can't be added here any more, and go on to the next table.
+      help_copy(t);
+      freeze_run(t, h);
+      t = next;
+      continue;
+    }
+
+    int mask = t->size - 1;
+    int i = (int)(h & (uint64_t)mask);
+    bool full = true;
+    for (int probes=0; probes<t->size; probes++) {
+      uint64_t v = t->slots[i].load(memory_order_acquire);
+      if (v==0) {
+        if (t->number.load(memory_order_relaxed) >= t->size / 100 * MAX_LOAD_PERCENT) break;
+        if (t->slots[i].compare_exchange_strong(v, pack(e), memory_order_acq_rel)) {
+          t->number.fetch_add(1, memory_order_relaxed);
+          return e;
+        }
+        // Lost the race for this slot; v is now what won.
+      }
+      if (holds(v, h, e->keyID)) return unpack(v);
+      if (v & FROZEN) { full = false; break; }
+      i = (i+1) & mask;
+    }
+    // Too full (or being copied):  start the copy, if need be, and the
+    // top of the loop takes it from there.
+    if (full) grow(t);
+  }
+}
+
+bool ConcurrentHashDict::find(PuzzleState *key, PuzzleState *&pred) {
+  // Returns true iff the key is found.
+  // Returns the associated value in pred
+  string keyID = key->getUniqId();
+  entry *e = lookup(hash(keyID), keyID);
+  if (e==NULL) return false;
+  pred = e->data;
+  return true;
+}
+
+bool ConcurrentHashDict::find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred) {
+  entry *e = new entry;
+  e->key = key;
+  e->data = pred;
+  e->keyID = key->getUniqId();
+  e->hash = hash(e->keyID);
+  assert(((uintptr_t)e >> 48)==0 && ((uintptr_t)e & FROZEN)==0);
+
+  // Most states the search generates have been seen before, so look
+  // first:  that doesn't write to shared memory.
+  entry *there = lookup(e->hash, e->keyID);
+  if (there==NULL) there = insert(current.load(memory_order_acquire), e);
+  if (there==e) return false;
+  found_pred = there->data;
+  delete e;
+  return true;
+}
+
+// You may assume that no duplicate PuzzleState is ever added.
+void ConcurrentHashDict::add(PuzzleState *key, PuzzleState *pred) {
+  PuzzleState *ignored;
+  find_or_add(key, pred, ignored);
+}
+
+#endif
@@ -0,0 +1,103 @@
+//ConcurrentHashDict.hpp
+#ifndef _CONCURRENTHASHDICT_HPP
+#define _CONCURRENTHASHDICT_HPP
+
+#include "PredDict.hpp"
+#include <atomic>
+#include <stdint.h>
+
+// An implementation of a dictionary as a hash table that any number of
+// threads can use at once, without locks.
+//
+// The table is linear probing over 64-bit slot words.  A full slot
+// packs 16 bits of the key's hash (its tag) above a pointer to an
+// entry holding the key, its keyID and its predecessor; entries never
+// change once published.  A new key goes in with one compare-and-swap
+// of an empty slot, so two threads adding the same state can't both
+// succeed:  the loser sees the winner's entry and reports it as found.
+// find() never writes and never waits:  it's a bounded walk over
+// slots.
+//
+// When a table gets too full, a table twice its size is hung off it,
+// and every thread that runs into the old table helps copy it over,
+// a chunk of slots at a time.  A copied slot is frozen by setting its
+// low bit (entries are aligned, so pointers never use it); a frozen
+// empty slot is just that bit.  Readers that meet a frozen slot go on
+// to the next table.  A thread adding a key to the new table first
+// freezes the key's probe run in the old one, so the key can't be
+// added to the old table behind its back.
+//
+// Old tables are kept until the dictionary is destroyed.
+//
+class ConcurrentHashDict : public PredDict
+  {
+  public:
+    ConcurrentHashDict();
+    ~ConcurrentHashDict();
+    bool find(PuzzleState *key, PuzzleState *&pred);
+    void add(PuzzleState *key, PuzzleState *pred);
+
+    // Adds key unless an equal state is already there.  Returns true
+    // if it was there:  then found_pred is set to its predecessor, and
+    // the caller still owns key.  Returns false if key was added.
+    // Safe to call from many threads at once.
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred);
+
+    int count(); // how many keys are stored; only while no thread is adding
+    int tables() { return generations; } // how many tables have been made
+
+  private:
+    struct entry {
+      PuzzleState *key;
+      PuzzleState *data;
+      uint64_t hash; // Full hash of keyID
+      string keyID; // Avoid recomputation of key's getUniqId()
+    };
+
+    struct table {
+      int size; // number of slots; a power of two
+      atomic<uint64_t> *slots;
+      atomic<int> number; // keys added to this table
+      atomic<table *> next; // the bigger table being filled from this one
+      table *prev; // the table this one replaced
+      atomic<int> claimed; // chunks of slots handed to copying threads
+      atomic<int> copied; // chunks finished
+    };
+
+    const static int CHUNK = 1024; // slots copied per claim
+    const static uint64_t FROZEN = 1; // low bit of a copied slot
+    const static int MAX_LOAD_PERCENT = 60;
+
+    atomic<table *> current; // oldest table still in use
+    atomic<int> generations;
+
+    uint64_t hash(const string &keyID); // The hash function
+    inline uint64_t pack(entry *e) {
+      return ((e->hash >> 48) << 48) | (uint64_t)(uintptr_t)e;
+    }
+    inline entry *unpack(uint64_t v) {
+      return (entry *)(uintptr_t)(v & ((1ull << 48) - 1) & ~FROZEN);
+    }
+    // True if slot word v holds the key with hash h and id keyID.
+    inline bool holds(uint64_t v, uint64_t h, const string &keyID) {
+      if ((v >> 48) != (h >> 48) || (v & ~FROZEN)==0) return false;
+      entry *e = unpack(v);
+      return e->hash==h && e->keyID==keyID;
+    }
+    inline int chunks(table *t) { return (t->size + CHUNK-1) / CHUNK; }
+
+    table *make_table(int size);
+    entry *lookup(uint64_t h, const string &keyID);
+    // Adds e to t (or the table after it) unless its key is there.
+    // Returns the entry that ends up holding the key.
+    entry *insert(table *t, entry *e);
+    void grow(table *t); // hangs a bigger table off t, if nobody has yet
+    void help_copy(table *t); // copies chunks of t until none are left
+    // Copies slot i of t to the next table and freezes it.  Returns
+    // true if the slot was empty.
+    bool copy_slot(table *t, int i);
+    void freeze_run(table *t, uint64_t h); // freezes h's probe run in t
+    void advance(); // moves 'current' past fully copied tables
+  };
+
+#endif
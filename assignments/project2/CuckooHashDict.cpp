@@ -0,0 +1,209 @@
+#ifndef _CUCKOOHASHDICT_CPP
+#define _CUCKOOHASHDICT_CPP
+
+//CuckooHashDict.cpp
+#include "CuckooHashDict.hpp"
+#include "KeyHash.hpp"
+#include <cassert>
+#include <cstdlib>//for NULL
+#include <iostream>
+
+// An implementation of a dictionary ADT as a bucketized cuckoo hash table.
+//
+
+CuckooHashDict::CuckooHashDict() {
+  size = 16;
+  table = new bucket[size]();
+  limit = size * SLOTS * 9 / 10;
+  rehashes = 0;
+
+  // Initialize the arrays of counters for statistics
+  probes_stats = new stat_counter[MAX_STATS];
+  kicks_stats = new int[MAX_STATS]();
+}
+
+CuckooHashDict::~CuckooHashDict() {
+  // Delete all the keys...
+  for (size_t i=0; i<entries.size(); i++) {
+    delete entries[i].key;
+    // Don't delete data here, to avoid double deletions.
+  }
+  delete [] table;
+
+  // It's not good style to put this into a destructor,
+  // but it's convenient for this assignment...
+  cout << "Probe Statistics for find():\n";
+  for (int i=0; i<MAX_STATS; i++)
+    cout << i << ": " << probes_stats[i] << endl;
+  cout << "Kick Statistics for add():\n";
+  for (int i=0; i<MAX_STATS; i++)
+    cout << i << ": " << kicks_stats[i] << endl;
+  cout << "Stashed: " << stash.size() << ", rehashes: " << rehashes << endl;
+  delete [] probes_stats;
+  delete [] kicks_stats;
+}
+
+uint64_t CuckooHashDict::hash(const string &keyID) {
+  // Both halves depend on every character.
+  return FNVHash::hash(keyID);
+}
+
+int CuckooHashDict::search(int b, uint32_t fp, uint64_t h, const string &keyID) {
+  for (int s=0; s<SLOTS; s++) {
+    if (table[b].fingerprint[s]==fp) {
+      entry &e = entries[table[b].index[s]];
+      if (e.hash==h && e.keyID==keyID) return s;
+    }
+  }
+  return -1;
+}
+
+bool CuckooHashDict::put(int b, uint32_t i) {
+  for (int s=0; s<SLOTS; s++) {
+    if (table[b].fingerprint[s]==0) {
+      table[b].fingerprint[s] = fingerprint(entries[i].hash);
+      table[b].index[s] = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool CuckooHashDict::place(uint32_t i, int &kicks) {
+  uint64_t h = entries[i].hash;
+  kicks = 0;
+  if (put(bucket1(h), i) || put(bucket2(h), i)) return true;
+
+  // Both full:  evict someone from the first bucket, and send them to
+  // their other bucket, and so on.  The slot to evict cycles, so we
+  // don't just bounce the same two keys back and forth.
+  int b = bucket1(h);
+  uint32_t homeless = i;
+  for (kicks=1; kicks<=MAX_KICKS; kicks++) {
+    int s = (int)((homeless + (uint32_t)kicks) % SLOTS);
+    uint32_t evicted = table[b].index[s];
+    table[b].fingerprint[s] = fingerprint(entries[homeless].hash);
+    table[b].index[s] = homeless;
+    homeless = evicted;
+
+    uint64_t eh = entries[homeless].hash;
+    b = (b==bucket1(eh)) ? bucket2(eh) : bucket1(eh);
+    if (put(b, homeless)) return true;
+  }
+
+  if ((int)stash.size() < MAX_STASH) {
+    stash.push_back(homeless);
+    return true;
+  }
+  // The homeless key isn't anywhere now, but rehash() puts back
+  // every entry, so it won't be lost.
+  return false;
+}
+
+void CuckooHashDict::rehash() {
+  // Each entry keeps its full hash, so no key is read again.  With
+  // more buckets the chance of a failed placement drops; if one
+  // happens anyway, double again.
+  bool placed = false;
+  while (!placed) {
+    delete [] table;
+    size *= 2;
+    table = new bucket[size]();
+    limit = size * SLOTS * 9 / 10;
+    stash.clear();
+    rehashes++;
+
+    placed = true;
+    int kicks;
+    for (uint32_t i=0; placed && i<entries.size(); i++) placed = place(i, kicks);
+  }
+}
+
+bool CuckooHashDict::find(PuzzleState *key, PuzzleState *&pred) {
+  // Returns true iff the key is found.
+  // Returns the associated value in pred
+
+  return find(key, key->getUniqId(), pred);
+}
+
+bool CuckooHashDict::find(PuzzleState *, const string &keyID, PuzzleState *&pred) {
+  int probes = 1;
+  entry *e = lookup(hash(keyID), keyID, probes);
+  if (e!=NULL) pred = e->data;
+  probes_stats[probes]++;
+  return e!=NULL;
+}
+
+CuckooHashDict::entry *CuckooHashDict::lookup(uint64_t h, const string &keyID, int &probes) {
+  uint32_t fp = fingerprint(h);
+  int b = bucket1(h);
+  int s = search(b, fp, h, keyID);
+  if (s < 0) {
+    probes++;
+    b = bucket2(h);
+    s = search(b, fp, h, keyID);
+  }
+  if (s >= 0) return &entries[table[b].index[s]];
+  if (!stash.empty()) {
+    probes++;
+    for (size_t j=0; j<stash.size(); j++) {
+      entry &e = entries[stash[j]];
+      if (e.hash==h && e.keyID==keyID) return &e;
+    }
+  }
+  return NULL;
+}
+
+void CuckooHashDict::insert_last() {
+  if ((int)entries.size() > limit) {
+    rehash();
+    return;
+  }
+  int kicks;
+  bool placed = place((uint32_t)(entries.size()-1), kicks);
+  kicks_stats[(kicks < MAX_STATS) ? kicks : MAX_STATS-1]++;
+  if (!placed) rehash();
+}
+
+// You may assume that no duplicate PuzzleState is ever added.
+void CuckooHashDict::add(PuzzleState *key, PuzzleState *pred) {
+  string keyID = key->getUniqId();
+  add(key, pred, keyID);
+}
+
+void CuckooHashDict::add(PuzzleState *key, PuzzleState *pred, string &keyID) {
+  entry e;
+  e.key = key;
+  e.keyID.swap(keyID);
+  e.hash = hash(e.keyID);
+  e.data = pred;
+  entries.push_back(e);
+  entries.back().keyID.swap(e.keyID);
+  insert_last();
+}
+
+bool CuckooHashDict::find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred) {
+  string keyID = key->getUniqId();
+  return find_or_add(key, pred, keyID, found_pred);
+}
+
+bool CuckooHashDict::find_or_add(PuzzleState *key, PuzzleState *pred, string &keyID, PuzzleState *&found_pred) {
+  entry e;
+  e.keyID.swap(keyID);
+  e.hash = hash(e.keyID);
+  int probes = 1;
+  entry *there = lookup(e.hash, e.keyID, probes);
+  probes_stats[probes]++;
+  if (there!=NULL) {
+    found_pred = there->data;
+    return true;
+  }
+  e.key = key;
+  e.data = pred;
+  entries.push_back(e);
+  entries.back().keyID.swap(e.keyID);
+  insert_last();
+  return false;
+}
+
+#endif
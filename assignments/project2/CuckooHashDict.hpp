@@ -0,0 +1,109 @@
+//CuckooHashDict.hpp
+#ifndef _CUCKOOHASHDICT_HPP
+#define _CUCKOOHASHDICT_HPP
+
+#include "PredDict.hpp"
+#include "StatCounter.hpp"
+#include <stdint.h>
+#include <vector>
+
+// An implementation of a dictionary as a bucketized cuckoo hash table.
+//
+// Every key has two possible buckets, each with room for 4 keys, and
+// is always in one of them (or in a small overflow "stash").  So find()
+// searches no more than two buckets, each one 32-byte cache line, no
+// matter how unlucky the hashing was.  That bounds the lines a miss
+// reads (bar a rare fingerprint match); a hit then reads its entry and
+// its keyID's characters too, to compare them, so it touches three or
+// four lines in all.  The price of the bound is paid by add():
+// when both buckets are full, it evicts ("kicks") a key to that key's
+// other bucket, which may kick another, and so on.  After MAX_KICKS
+// the key left over goes to the stash, and if the stash is full too,
+// the table doubles.
+//
+// Buckets hold a 32-bit fingerprint of each key's hash and the key's
+// index in a separate array of entries, which keep the keyID and the
+// full hash (so kicks and rehashes never call getUniqId()).
+//
+class CuckooHashDict : public PredDict
+  {
+  public:
+    CuckooHashDict();
+    ~CuckooHashDict();
+    bool find(PuzzleState *key, PuzzleState *&pred);
+    void add(PuzzleState *key, PuzzleState *pred);
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred);
+    // The same three without calling getUniqId(), for a caller that
+    // has it already.  add() and find_or_add() may take keyID over.
+    bool find(PuzzleState *key, const string &keyID, PuzzleState *&pred);
+    void add(PuzzleState *key, PuzzleState *pred, string &keyID);
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, string &keyID, PuzzleState *&found_pred);
+
+    int count() { return (int)entries.size(); } // how many keys are stored
+    int capacity() { return size * SLOTS; } // how many slots there are
+    // How many find()s looked at i buckets (the stash counting as one).
+    int probes(int i) { return probes_stats[(i < MAX_STATS) ? i : MAX_STATS-1]; }
+    // How many add()s needed i kicks (the last counts the rest).
+    int kicks(int i) { return kicks_stats[(i < MAX_STATS) ? i : MAX_STATS-1]; }
+    int stashed() { return (int)stash.size(); } // keys in the stash now
+    int rehash_count() { return rehashes; } // how many times the table grew
+
+  private:
+    const static int SLOTS = 4; // keys per bucket
+    const static int MAX_KICKS = 500; // evictions before using the stash
+    const static int MAX_STASH = 8; // keys the stash can hold
+
+    struct alignas(32) bucket {
+      uint32_t fingerprint[SLOTS]; // 0 marks an empty slot
+      uint32_t index[SLOTS]; // into entries
+    };
+
+    struct entry {
+      PuzzleState *key;
+      uint64_t hash; // Full hash of keyID
+      string keyID; // Avoid recomputation of key's getUniqId()
+      PuzzleState *data;
+    };
+
+    bucket *table;
+    int size; // number of buckets
+    vector<entry> entries;
+    vector<uint32_t> stash; // indices of entries with no bucket
+    int limit; // most items the current table may hold
+
+    // Statistics:  buckets (and stash) looked at per find(), and
+    // evictions per add() (not counting adds that grew the table).
+    // Kicks that end in the stash are counted in the last counter.
+    stat_counter *probes_stats; // probe_stats[i] should be how often i probes needed
+    int *kicks_stats; // kicks_stats[i] is how often add() needed i kicks
+    const static int MAX_STATS = 20; // How big to make the arrays.
+    int rehashes; // how many times the table grew
+
+    uint64_t hash(const string &keyID); // The hash function
+    // The two buckets, from the two halves of the hash.
+    inline int bucket1(uint64_t h) { return (int)(((h & 0xffffffffu) * (uint32_t)size) >> 32); }
+    inline int bucket2(uint64_t h) {
+      int b = (int)(((h >> 32) * (uint32_t)size) >> 32);
+      return (b==bucket1(h)) ? (b+1) % size : b;
+    }
+    // A remix of the hash, never 0.
+    inline uint32_t fingerprint(uint64_t h) {
+      return (uint32_t)(((h ^ (h >> 29)) * 0xbf58476d1ce4e5b9ull) >> 32) | 1u;
+    }
+    // Returns the slot in bucket b holding fingerprint fp and a key
+    // whose keyID is keyID, or -1.
+    int search(int b, uint32_t fp, uint64_t h, const string &keyID);
+    // Looks in both buckets and the stash, counting them in probes.
+    entry *lookup(uint64_t h, const string &keyID, int &probes);
+    // Finds a place for the last entry, growing the table if need be.
+    void insert_last();
+    // Puts entry i into an empty slot of bucket b, if there is one.
+    bool put(int b, uint32_t i);
+    // Finds a home for entry i, kicking others as needed, and sets
+    // kicks to the number of evictions.  Returns false if the table
+    // has to grow.
+    bool place(uint32_t i, int &kicks);
+    void rehash(); // Doubles the table and puts every entry back
+  };
+
+#endif
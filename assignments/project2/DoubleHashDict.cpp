@@ -6,11 +6,14 @@
 #include <cassert>
 #include <cstdlib>//for NULL
 #include <iostream>
+#include <chrono>
+#include <new>
 
 // An implementation of a dictionary ADT as hash table with double hashing
 //
 
-const int DoubleHashDict::primes[] = {53, 97, 193, 389, 769, 1543, 3079,
+template <class Hash>
+const int BasicDoubleHashDict<Hash>::primes[] = {53, 97, 193, 389, 769, 1543, 3079,
       6151, 12289, 24593, 49157, 98317, 196613, 393241, 786433, 1572869,
       3145739, 6291469, 12582917, 25165843, 50331653, 100663319,
       201326611, 402653189, 805306457, 1610612741, -1};
@@ -19,17 +22,29 @@ const int DoubleHashDict::primes[] = {53, 97, 193, 389, 769, 1543, 3079,
 // The -1 at the end is to guarantee an immediate crash if we run off
 // the end of the array.
 
-DoubleHashDict::DoubleHashDict() {
+template <class Hash>
+BasicDoubleHashDict<Hash>::BasicDoubleHashDict(double load, bool gradual) {
   size_index = 0;
   size = primes[size_index];
-  table = new bucket[size](); // Parentheses force initialization to 0
+  table = allocate(size);
+  for (int i=0; i<size; i++) new (&table[i]) bucket(); // Parentheses force initialization to 0
   number = 0;
+  max_load = load;
+  limit = (int)(size * max_load);
+  old_table = NULL;
+  old_size = 0;
+  old_next = 0;
+  spare = NULL;
+  spare_built = 0;
+  incremental = gradual;
+  max_add_ns = 0;
 
   // Initialize the array of counters for probe statistics
-  probes_stats = new int[MAX_STATS]();
+  probes_stats = new stat_counter[MAX_STATS];
 }
 
-DoubleHashDict::~DoubleHashDict() {
+template <class Hash>
+BasicDoubleHashDict<Hash>::~BasicDoubleHashDict() {
   // Delete all table entries...
   for (int i=0; i<size; i++) {
     if (table[i].key!=NULL) {
@@ -38,50 +53,49 @@ DoubleHashDict::~DoubleHashDict() {
     }
   }
   // Delete the table itself
-  delete [] table;
+  release(table, size);
+  // ...and anything not yet moved out of the old one.
+  if (old_table!=NULL) {
+    for (int i=old_next; i<old_size; i++) {
+      if (old_table[i].key!=NULL) delete old_table[i].key;
+    }
+    release(old_table, old_size);
+  }
+  if (spare!=NULL) release(spare, spare_built);
 
   // It's not good style to put this into a destructor,
   // but it's convenient for this assignment...
   cout << "Probe Statistics for find():\n";
   for (int i=0; i<MAX_STATS; i++)
     cout << i << ": " << probes_stats[i] << endl;
+  cout << "Longest add(): " << max_add_ns << " ns\n";
   delete [] probes_stats;
 }
 
-int DoubleHashDict::hash1(string keyID) {
-  int h=0;
-  for (int i=keyID.length()-1; i>=0; i--) {
-    h = (keyID[i] + 31*h) % size;
-  }
+template <class Hash>
+uint64_t BasicDoubleHashDict<Hash>::hash(const string &keyID) {
+  // One pass over the key, no division; both halves get used.
+  uint64_t h = Hash::hash(keyID);
 // 221 Students:  DO NOT CHANGE OR DELETE THE NEXT FEW LINES!!!
 // We will use this code when marking to be able to watch what
 // your program is doing, so if you change things, we'll mark it wrong.
 #ifdef MARKING_TRACE
-std::cout << "Hash 1:  " << keyID << " to " << h << std::endl;
+std::cout << "Hash 1:  " << keyID << " to " << hash1(h) << std::endl;
 #endif
 // End of "DO NOT CHANGE" Block
-  return h;
-}
-
-int DoubleHashDict::hash2(string keyID) {
-  int h=0;
-  for (int i=keyID.length()-1; i>=0; i--) {
-    h = (keyID[i] + 63*h) % size;
-  }
-  // Make sure second hash is never 0 or size
-  h = h/2 + 1;
 
 // 221 Students:  DO NOT CHANGE OR DELETE THE NEXT FEW LINES!!!
 // We will use this code when marking to be able to watch what
 // your program is doing, so if you change things, we'll mark it wrong.
 #ifdef MARKING_TRACE
-std::cout << "Hash 2:  " << keyID << " to " << h << std::endl;
+std::cout << "Hash 2:  " << keyID << " to " << hash2(h) << std::endl;
 #endif
 // End of "DO NOT CHANGE" Block
   return h;
 }
 
-void DoubleHashDict::rehash() {
+template <class Hash>
+void BasicDoubleHashDict<Hash>::rehash() {
 // 221 Students:  DO NOT CHANGE OR DELETE THE NEXT FEW LINES!!!
 // And leave this at the beginning of the rehash() function.
 // We will use this code when marking to be able to watch what
@@ -92,7 +106,21 @@ std::cout << "*** REHASHING " << size;
 // End of "DO NOT CHANGE" Block
 
 
-  // TODO:  Your code goes here...
+  // Any earlier move has to be finished first.
+  if (old_table!=NULL) migrate(old_size);
+
+  old_table = table;
+  old_size = size;
+  old_next = 0;
+
+  prepare(primes[size_index+1]); // builds whatever is left to build
+  table = spare;
+  spare = NULL;
+  size_index++;
+  size = primes[size_index];
+  limit = (int)(size * max_load);
+
+  if (!incremental) migrate(old_size);
 
 
 // 221 Students:  DO NOT CHANGE OR DELETE THE NEXT FEW LINES!!!
@@ -105,20 +133,212 @@ std::cout << " to " << size << " ***\n";
 // End of "DO NOT CHANGE" Block
 }
 
-bool DoubleHashDict::find(PuzzleState *key, PuzzleState *&pred) {
+template <class Hash>
+void BasicDoubleHashDict<Hash>::insert(uint64_t h, PuzzleState *key, string &keyID, PuzzleState *data) {
+  int i = hash1(h);
+  int step = hash2(h);
+  while (table[i].key!=NULL) {
+    i += step;
+    if (i>=size) i -= size;
+  }
+  table[i].key = key;
+  table[i].hash = h;
+  table[i].keyID.swap(keyID);
+  table[i].data = data;
+}
+
+template <class Hash>
+void BasicDoubleHashDict<Hash>::migrate(int buckets) {
+  // Probe with the cached hashes; the keys themselves aren't touched.
+  // Moved buckets keep their key and hash (just not their keyID), so
+  // find()'s probe sequences through the old table still work.
+  for (; buckets>0 && old_next<old_size; buckets--, old_next++) {
+    bucket &b = old_table[old_next];
+    if (b.key!=NULL) insert(b.hash, b.key, b.keyID, b.data);
+  }
+  if (old_next==old_size) {
+    release(old_table, old_size);
+    old_table = NULL;
+  }
+}
+
+template <class Hash>
+typename BasicDoubleHashDict<Hash>::bucket *BasicDoubleHashDict<Hash>::allocate(int n) {
+  return static_cast<bucket *>(::operator new(sizeof(bucket) * (size_t)n));
+}
+
+template <class Hash>
+void BasicDoubleHashDict<Hash>::release(bucket *t, int built) {
+  for (int i=0; i<built; i++) t[i].~bucket();
+  ::operator delete(t);
+}
+
+template <class Hash>
+void BasicDoubleHashDict<Hash>::prepare(int buckets) {
+  int n = primes[size_index+1];
+  if (spare==NULL) {
+    spare = allocate(n);
+    spare_built = 0;
+  }
+  for (; buckets>0 && spare_built<n; buckets--, spare_built++) {
+    new (&spare[spare_built]) bucket();
+  }
+}
+
+template <class Hash>
+typename BasicDoubleHashDict<Hash>::bucket *BasicDoubleHashDict<Hash>::search(bucket *t, int n, uint64_t h, const string &keyID, int &probes,
+                                               int &stop) {
+  int i = hash1(h, n);
+  int step = hash2(h, n);
+  while (t[i].key!=NULL) {
+    probes++;
+    if (t[i].hash==h && t[i].keyID==keyID) return &t[i];
+    i += step;
+    if (i>=n) i -= n;
+  }
+  probes++; // the empty bucket that stopped us
+  stop = i;
+  return NULL;
+}
+
+template <class Hash>
+bool BasicDoubleHashDict<Hash>::find(PuzzleState *key, PuzzleState *&pred) {
   // Returns true iff the key is found.
   // Returns the associated value in pred
 
-  // Be sure not to keep calling getUniqId() over and over again!
+  return find(key, key->getUniqId(), pred);
+}
 
-  // TODO:  Your code goes here...
-  return true; // Stub:  Delete this line when you've implemented the function
+template <class Hash>
+bool BasicDoubleHashDict<Hash>::find(PuzzleState *, const string &keyID, PuzzleState *&pred) {
+  if (old_table!=NULL) migrate(MIGRATE_STEP);
+  uint64_t h = hash(keyID);
+  int probes = 0, stop;
+  bucket *b = search(table, size, h, keyID, probes, stop);
+  // Anything not in the new table yet is still in the old one.
+  if (b==NULL && old_table!=NULL) b = search(old_table, old_size, h, keyID, probes, stop);
+  if (b!=NULL) pred = b->data;
+  probes_stats[(probes < MAX_STATS) ? probes : MAX_STATS-1]++;
+  return b!=NULL;
+}
+
+template <class Hash>
+bool BasicDoubleHashDict<Hash>::make_room() {
+  bool moved = (old_table!=NULL);
+  if (moved) migrate(MIGRATE_STEP);
+  else if (incremental && number >= limit/2) prepare(BUILD_STEP);
+  if (number+1 > limit) {
+    rehash();
+    moved = true;
+  }
+  return moved;
 }
 
 // You may assume that no duplicate PuzzleState is ever added.
-void DoubleHashDict::add(PuzzleState *key, PuzzleState *pred) {
+template <class Hash>
+void BasicDoubleHashDict<Hash>::add(PuzzleState *key, PuzzleState *pred) {
+  string keyID = key->getUniqId();
+  add(key, pred, keyID);
+}
 
-  // TODO:  Your code goes here...
+template <class Hash>
+void BasicDoubleHashDict<Hash>::add(PuzzleState *key, PuzzleState *pred, string &keyID) {
+  // Only an add() that makes room can be slow, so only those are timed.
+  bool timed = room_needed();
+  chrono::steady_clock::time_point start;
+  if (timed) {
+    start = chrono::steady_clock::now();
+    make_room();
+  }
+  insert(hash(keyID), key, keyID, pred);
+  number++;
+  if (timed) {
+    long took = (long)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    if (took > max_add_ns) max_add_ns = took;
+  }
+}
+
+template <class Hash>
+bool BasicDoubleHashDict<Hash>::find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred) {
+  // One id, one hash, one probe sequence.
+  string keyID = key->getUniqId();
+  return resolve(key, pred, keyID, hash(keyID), found_pred);
 }
 
-#endif 
+template <class Hash>
+bool BasicDoubleHashDict<Hash>::find_or_add(PuzzleState *key, PuzzleState *pred, string &keyID, PuzzleState *&found_pred) {
+  return resolve(key, pred, keyID, hash(keyID), found_pred);
+}
+
+template <class Hash>
+void BasicDoubleHashDict<Hash>::find_or_add_batch(int n, PuzzleState *keys[], PuzzleState *preds[],
+                                       bool found[], PuzzleState *found_preds[]) {
+  // All the hashing first, asking for each first bucket as we go, so
+  // the misses overlap.  A bucket can straddle two cache lines.
+  batch_ids.resize((size_t)n);
+  batch_hashes.resize((size_t)n);
+  for (int i=0; i<n; i++) {
+    batch_ids[i] = keys[i]->getUniqId();
+    batch_hashes[i] = hash(batch_ids[i]);
+    bucket *b = &table[hash1(batch_hashes[i])];
+    __builtin_prefetch(b);
+    __builtin_prefetch((char *)(b+1) - 1);
+  }
+  // By now the first buckets are arriving.  A key that's there has its
+  // keyID compared, which is a miss of its own; if it isn't, the next
+  // bucket will be wanted.  Ask for either.
+  for (int i=0; i<n; i++) {
+    uint64_t h = batch_hashes[i];
+    int j = hash1(h);
+    if (table[j].key==NULL) continue;
+    if (table[j].hash==h) {
+      __builtin_prefetch(table[j].keyID.data());
+    } else {
+      j += hash2(h);
+      if (j>=size) j -= size;
+      __builtin_prefetch(&table[j]);
+    }
+  }
+  // If an add grows the table, later prefetches were wasted, no more.
+  for (int i=0; i<n; i++) {
+    found[i] = resolve(keys[i], preds[i], batch_ids[i], batch_hashes[i], found_preds[i]);
+  }
+}
+
+template <class Hash>
+bool BasicDoubleHashDict<Hash>::resolve(PuzzleState *key, PuzzleState *pred, string &keyID, uint64_t h, PuzzleState *&found_pred) {
+  int probes = 0, stop = 0, old_stop;
+  bucket *b = search(table, size, h, keyID, probes, stop);
+  if (b==NULL && old_table!=NULL) b = search(old_table, old_size, h, keyID, probes, old_stop);
+  probes_stats[(probes < MAX_STATS) ? probes : MAX_STATS-1]++;
+  if (b!=NULL) {
+    found_pred = b->data;
+    return true;
+  }
+
+  // Only a key that's going in makes room.  If that moves buckets, the
+  // empty bucket the search ended at may not be the first one any more.
+  bool timed = room_needed();
+  chrono::steady_clock::time_point start;
+  if (timed) {
+    start = chrono::steady_clock::now();
+    if (make_room()) search(table, size, h, keyID, probes, stop);
+  }
+  table[stop].key = key;
+  table[stop].hash = h;
+  table[stop].keyID.swap(keyID);
+  table[stop].data = pred;
+  number++;
+  if (timed) {
+    long took = (long)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    if (took > max_add_ns) max_add_ns = took;
+  }
+  return false;
+}
+
+template class BasicDoubleHashDict<FNVHash>;
+template class BasicDoubleHashDict<PolyHash>;
+template class BasicDoubleHashDict<MixHash>;
+template class BasicDoubleHashDict<CRCHash>;
+
+#endif
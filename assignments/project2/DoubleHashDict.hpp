@@ -3,21 +3,60 @@
 #define _DOUBLEHASHDICT_HPP
 
 #include "PredDict.hpp"
+#include "StatCounter.hpp"
+#include "KeyHash.hpp"
+#include <stdint.h>
+#include <vector>
 
 // An implementation of a dictionary as a hash table with double hashing
 //
-class DoubleHashDict : public PredDict
+// Each key is hashed once, to 64 bits.  The low half picks the first
+// bucket and the high half picks the step, and the whole hash is kept
+// in the bucket, so growing the table never reads a key again.
+//
+// With 'incremental' set, the table grows a little at a time, as in
+// LinearHashDict:  the old table stays beside the new one, every add()
+// and find() moves MIGRATE_STEP of its buckets across, and find()
+// looks in both until it's empty.
+//
+// Hash is the hash function:  one of the policies in KeyHash.hpp, all
+// of which DoubleHashDict.cpp instantiates.  Plain DoubleHashDict uses
+// FNVHash.
+//
+template <class Hash>
+class BasicDoubleHashDict : public PredDict
   {
   public:
-    DoubleHashDict();
-    ~DoubleHashDict();
+    // max_load is the fraction of buckets allowed to fill before
+    // the table grows.
+    BasicDoubleHashDict(double max_load = 0.5, bool incremental = false);
+    ~BasicDoubleHashDict();
     bool find(PuzzleState *key, PuzzleState *&pred);
     void add(PuzzleState *key, PuzzleState *pred);
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred);
+    // The same three given key's keyID, as ShardedDict has it.  add()
+    // and find_or_add() may take keyID over.
+    bool find(PuzzleState *key, const string &keyID, PuzzleState *&pred);
+    void add(PuzzleState *key, PuzzleState *pred, string &keyID);
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, string &keyID, PuzzleState *&found_pred);
+    // Hashes every key and prefetches its first bucket, then resolves
+    // them in order.
+    void find_or_add_batch(int n, PuzzleState *keys[], PuzzleState *preds[],
+                           bool found[], PuzzleState *found_preds[]);
+
+    int count() { return number; } // how many keys are stored
+    int capacity() { return size; } // how many buckets there are
+    // The slowest add() so far that had to make room (see room_needed()),
+    // in ns.  Only those are timed; the rest just place a key.
+    long longest_add() { return max_add_ns; }
+    // How many find()s so far took i probes (the last counts the rest).
+    int probes(int i) { return probes_stats[(i < MAX_STATS) ? i : MAX_STATS-1]; }
 
   private:
     struct bucket {
       PuzzleState *key; // NULL indicates empty bucket.
       // No need for tombstones, as we never delete.
+      uint64_t hash; // Full hash of keyID, for probing and rehashing
       string keyID; // Avoid recomputation of key's getUniqId()
       PuzzleState *data;
     };
@@ -32,16 +71,68 @@ class DoubleHashDict : public PredDict
     int size_index; // index of the current table size in the primes[] array
                     // Invariant:  size == primes[size_index]
     int number; // how many items are currently in hash table
+    double max_load; // largest allowed number/size
+    int limit; // most items the current table may hold
+
+    // The table being emptied into 'table' by an incremental rehash
+    // (NULL if none).  Its buckets below old_next have been moved.
+    bucket *old_table;
+    int old_size;
+    int old_next;
+    bool incremental;
+    const static int MIGRATE_STEP = 16; // old buckets moved per add()/find()
+    // Building the next table's empty buckets takes time too, so an
+    // incremental table builds it ahead, BUILD_STEP buckets per add(),
+    // once it's half way to growing.  'spare' has spare_built buckets
+    // built so far.
+    bucket *spare;
+    int spare_built;
+    const static int BUILD_STEP = 64;
+    long max_add_ns; // the slowest add() so far
+    vector<string> batch_ids; // find_or_add_batch()'s keyIDs...
+    vector<uint64_t> batch_hashes; // ...and their hashes
 
     // The next two variables are just to collect statistics on the
     // number of probes required for each call to find().
-    int *probes_stats; // probe_stats[i] should be how often i probes needed
+    stat_counter *probes_stats; // probe_stats[i] should be how often i probes needed
     const static int MAX_STATS = 20; // How big to make the array.
 
-    int hash1(string keyID); // The hash function
-    int hash2(string keyID); // The secondary hash function
+    uint64_t hash(const string &keyID); // The hash function
+    // The first bucket to try in a table of n, from the low half of
+    // the hash.
+    inline int hash1(uint64_t h, int n) { return (int)(((h & 0xffffffffu) * (uint32_t)n) >> 32); }
+    inline int hash1(uint64_t h) { return hash1(h, size); }
+    // The step between buckets, from the high half:  1..n-1, so (n
+    // being prime) every probe sequence visits every bucket.
+    inline int hash2(uint64_t h, int n) { return 1 + (int)(((h >> 32) * (uint32_t)(n-1)) >> 32); }
+    inline int hash2(uint64_t h) { return hash2(h, size); }
+    // Looks for keyID in t (of n buckets), adding the buckets looked
+    // at to probes.  If it's not there, stop is the empty bucket that
+    // ended the search.
+    bucket *search(bucket *t, int n, uint64_t h, const string &keyID, int &probes, int &stop);
+    // Puts a key known to be new into the current table.
+    void insert(uint64_t h, PuzzleState *key, string &keyID, PuzzleState *data);
+    // find_or_add() of a key whose keyID and hash are known; keyID is
+    // taken over if the key is added.
+    bool resolve(PuzzleState *key, PuzzleState *pred, string &keyID, uint64_t h, PuzzleState *&found_pred);
+    // Whether an add() has more to do than place its key:  migrating,
+    // building the spare table or growing.
+    inline bool room_needed() {
+      return old_table!=NULL || (incremental && number >= limit/2) || number+1 > limit;
+    }
+    // Does all that.  Returns true if it moved buckets into the table,
+    // so that a search made before is out of date.
+    bool make_room();
+    void migrate(int buckets); // Moves up to that many old buckets over
+    // Tables are allocated raw, so buckets can be built a few at a time.
+    static bucket *allocate(int n);
+    static void release(bucket *t, int built); // destroys built buckets, frees t
+    void prepare(int buckets); // Builds up to that many more spare buckets
     void rehash(); // Resizes to next bigger table and rehashes everything
+                   // (or, if incremental, starts to)
   };
 
+typedef BasicDoubleHashDict<FNVHash> DoubleHashDict;
+
 #endif
 
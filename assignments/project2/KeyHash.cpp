@@ -0,0 +1,94 @@
+#ifndef _KEYHASH_CPP
+#define _KEYHASH_CPP
+
+//KeyHash.cpp
+#include "KeyHash.hpp"
+#include <cstring>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+namespace {
+  // The first of the two rounds of MurmurHash3's 64-bit finish:  the
+  // shifts bring high bits down, and the multiply carries low bits up.
+  inline uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+  }
+
+  // The next 8 bytes of a key, as one word.
+  inline uint64_t word(const char *p) {
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+  }
+
+#if !defined(__SSE4_2__)
+  // CRC32C (the Castagnoli polynomial, reflected), a byte at a time.
+  struct crc_table {
+    uint32_t entry[256];
+    crc_table() {
+      for (uint32_t i=0; i<256; i++) {
+        uint32_t c = i;
+        for (int k=0; k<8; k++) c = (c >> 1) ^ ((c & 1) ? 0x82f63b78u : 0);
+        entry[i] = c;
+      }
+    }
+  };
+  const crc_table crc32c;
+#endif
+}
+
+uint64_t FNVHash::hash(const string &keyID) {
+  // FNV-1a, 64 bits wide:  one xor and one multiply per character.
+  uint64_t h = 14695981039346656037ull;
+  for (size_t i=0; i<keyID.length(); i++) {
+    h = (h ^ (unsigned char)keyID[i]) * 1099511628211ull;
+  }
+  return mix(h);
+}
+
+uint64_t PolyHash::hash(const string &keyID) {
+  // Horner's rule, with the 64-bit overflow standing in for the mod.
+  uint64_t h = 0;
+  for (size_t i=0; i<keyID.length(); i++) {
+    h = 31*h + (unsigned char)keyID[i];
+  }
+  return mix(h);
+}
+
+uint64_t MixHash::hash(const string &keyID) {
+  const char *p = keyID.data();
+  size_t n = keyID.length();
+  uint64_t h = 0x9e3779b97f4a7c15ull ^ n;
+  for (; n>=8; n-=8, p+=8) {
+    h = (h ^ word(p)) * 0x9e3779b97f4a7c15ull;
+    h = (h << 31) | (h >> 33);
+  }
+  // The last few bytes, as one more (short) word.
+  uint64_t last = 0;
+  memcpy(&last, p, n);
+  h = (h ^ last) * 0x9e3779b97f4a7c15ull;
+  return mix(h);
+}
+
+uint64_t CRCHash::hash(const string &keyID) {
+  const char *p = keyID.data();
+  size_t n = keyID.length();
+  uint32_t c = 0xffffffffu;
+#if defined(__SSE4_2__)
+  uint64_t c64 = c;
+  for (; n>=8; n-=8, p+=8) c64 = _mm_crc32_u64(c64, word(p));
+  c = (uint32_t)c64;
+  for (; n>0; n--, p++) c = _mm_crc32_u8(c, (unsigned char)*p);
+#else
+  for (; n>0; n--, p++) c = (c >> 8) ^ crc32c.entry[(c ^ (unsigned char)*p) & 0xff];
+#endif
+  // Spread the 32 bits (and the length) over 64.
+  return mix(((uint64_t)keyID.length() << 32 | (uint64_t)~c) * 0x9e3779b97f4a7c15ull);
+}
+
+#endif
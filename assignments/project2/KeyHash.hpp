@@ -0,0 +1,43 @@
+//KeyHash.hpp
+#ifndef _KEYHASH_HPP
+#define _KEYHASH_HPP
+
+#include <stdint.h>
+#include <string>
+using namespace std;
+
+// Hash functions for keyIDs, as policies for BasicLinearHashDict and
+// BasicDoubleHashDict.  Each gives 64 bits, with both halves depending
+// on every character, since the tables use one half or both.  They
+// differ in how they take in the key:
+//
+//   FNVHash   FNV-1a, a byte at a time.  The default, and the hash
+//             every other dictionary here uses.
+//   PolyHash  The textbook polynomial, h = 31*h + c, a byte at a time.
+//   MixHash   Eight bytes at a time, a multiply and a rotate for each.
+//   CRCHash   CRC32C, eight bytes at a time with SSE4.2's crc32
+//             instruction (build with -msse4.2), or a table otherwise.
+//             Only 32 bits of it are independent:  two keys with the
+//             same CRC and length get the same 64 bits.
+//
+// All four finish with the same 64-bit mix, so the differences
+// between them come from the loop over the key.  hashquality compares
+// them.
+//
+struct FNVHash {
+  static uint64_t hash(const string &keyID);
+};
+
+struct PolyHash {
+  static uint64_t hash(const string &keyID);
+};
+
+struct MixHash {
+  static uint64_t hash(const string &keyID);
+};
+
+struct CRCHash {
+  static uint64_t hash(const string &keyID);
+};
+
+#endif
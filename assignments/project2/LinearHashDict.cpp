@@ -6,11 +6,15 @@
 #include <cassert>
 #include <cstdlib>//for NULL
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <new>
 
 // An implementation of the dictionary ADT as a hash table with linear probing
 //
 
-const int LinearHashDict::primes[] = {53, 97, 193, 389, 769, 1543, 3079,
+template <class Hash>
+const int BasicLinearHashDict<Hash>::primes[] = {53, 97, 193, 389, 769, 1543, 3079,
       6151, 12289, 24593, 49157, 98317, 196613, 393241, 786433, 1572869,
       3145739, 6291469, 12582917, 25165843, 50331653, 100663319,
       201326611, 402653189, 805306457, 1610612741, -1};
@@ -19,17 +23,29 @@ const int LinearHashDict::primes[] = {53, 97, 193, 389, 769, 1543, 3079,
 // The -1 at the end is to guarantee an immediate crash if we run off
 // the end of the array.
 
-LinearHashDict::LinearHashDict() {
+template <class Hash>
+BasicLinearHashDict<Hash>::BasicLinearHashDict(double load, bool gradual) {
   size_index = 0;
   size = primes[size_index];
-  table = new bucket[size](); // Parentheses force initialization to 0
+  table = allocate(size);
+  for (int i=0; i<size; i++) new (&table[i]) bucket(); // Parentheses force initialization to 0
   number = 0;
+  max_load = load;
+  limit = (int)(size * max_load);
+  old_table = NULL;
+  old_size = 0;
+  old_next = 0;
+  spare = NULL;
+  spare_built = 0;
+  incremental = gradual;
+  max_add_ns = 0;
 
   // Initialize the array of counters for probe statistics
-  probes_stats = new int[MAX_STATS]();
+  probes_stats = new stat_counter[MAX_STATS];
 }
 
-LinearHashDict::~LinearHashDict() {
+template <class Hash>
+BasicLinearHashDict<Hash>::~BasicLinearHashDict() {
   // Delete all table entries...
   for (int i=0; i<size; i++) {
     if (table[i].key!=NULL) {
@@ -38,21 +54,30 @@ LinearHashDict::~LinearHashDict() {
     }
   }
   // Delete the table itself
-  delete [] table;
+  release(table, size);
+  // ...and anything not yet moved out of the old one.
+  if (old_table!=NULL) {
+    for (int i=old_next; i<old_size; i++) {
+      if (old_table[i].key!=NULL) delete old_table[i].key;
+    }
+    release(old_table, old_size);
+  }
+  if (spare!=NULL) release(spare, spare_built);
 
   // It's not good style to put this into a destructor,
   // but it's convenient for this assignment...
   cout << "Probe Statistics for find():\n";
   for (int i=0; i<MAX_STATS; i++)
     cout << i << ": " << probes_stats[i] << endl;
+  cout << "Longest add(): " << max_add_ns << " ns\n";
   delete [] probes_stats;
 }
 
-int LinearHashDict::hash(string keyID) {
-  int h=0;
-  for (int i=keyID.length()-1; i>=0; i--) {
-    h = (keyID[i] + 31*h) % size;
-  }
+template <class Hash>
+uint32_t BasicLinearHashDict<Hash>::hash(const string &keyID) {
+  // The top half of the 64 bits; no division, as the table size is
+  // applied later, by home().
+  uint32_t h = (uint32_t)(Hash::hash(keyID) >> 32);
 // 221 Students:  DO NOT CHANGE OR DELETE THE NEXT FEW LINES!!!
 // We will use this code when marking to be able to watch what
 // your program is doing, so if you change things, we'll mark it wrong.
@@ -63,7 +88,8 @@ std::cout << "Hashing " << keyID << " to " << h << std::endl;
   return h;
 }
 
-void LinearHashDict::rehash() {
+template <class Hash>
+void BasicLinearHashDict<Hash>::rehash() {
 // 221 Students:  DO NOT CHANGE OR DELETE THE NEXT FEW LINES!!!
 // And leave this at the beginning of the rehash() function.
 // We will use this code when marking to be able to watch what
@@ -74,7 +100,21 @@ std::cout << "*** REHASHING " << size;
 // End of "DO NOT CHANGE" Block
 
 
-  // TODO:  Your code goes here...
+  // Any earlier move has to be finished first.
+  if (old_table!=NULL) migrate(old_size);
+
+  old_table = table;
+  old_size = size;
+  old_next = 0;
+
+  prepare(primes[size_index+1]); // builds whatever is left to build
+  table = spare;
+  spare = NULL;
+  size_index++;
+  size = primes[size_index];
+  limit = (int)(size * max_load);
+
+  if (!incremental) migrate(old_size);
 
 
 // 221 Students:  DO NOT CHANGE OR DELETE THE NEXT FEW LINES!!!
@@ -87,20 +127,243 @@ std::cout << " to " << size << " ***\n";
 // End of "DO NOT CHANGE" Block
 }
 
-bool LinearHashDict::find(PuzzleState *key, PuzzleState *&pred) {
+template <class Hash>
+void BasicLinearHashDict<Hash>::insert(bucket &entry, int i, int dist) {
+  // Walk on to the first empty bucket.  Any entry on the way that is
+  // closer to home than the one we're carrying gives up its bucket,
+  // and we carry it onwards instead.
+  while (table[i].key!=NULL) {
+    int theirs = displacement(table, size, i);
+    if (theirs < dist) {
+      swap(entry.key, table[i].key);
+      swap(entry.hash, table[i].hash);
+      entry.keyID.swap(table[i].keyID);
+      swap(entry.data, table[i].data);
+      dist = theirs;
+    }
+    i++;
+    if (i==size) i = 0;
+    dist++;
+  }
+  table[i].key = entry.key;
+  table[i].hash = entry.hash;
+  table[i].keyID.swap(entry.keyID);
+  table[i].data = entry.data;
+}
+
+template <class Hash>
+void BasicLinearHashDict<Hash>::migrate(int buckets) {
+  // The hash is cached in each bucket, so no key is read again.  Moved
+  // buckets keep their key and hash (just not their keyID), so the old
+  // table's runs stay whole for find() until it's all moved.
+  for (; buckets>0 && old_next<old_size; buckets--, old_next++) {
+    bucket &b = old_table[old_next];
+    if (b.key==NULL) continue;
+    bucket entry;
+    entry.key = b.key;
+    entry.hash = b.hash;
+    entry.keyID.swap(b.keyID);
+    entry.data = b.data;
+    insert(entry);
+  }
+  if (old_next==old_size) {
+    release(old_table, old_size);
+    old_table = NULL;
+  }
+}
+
+template <class Hash>
+typename BasicLinearHashDict<Hash>::bucket *BasicLinearHashDict<Hash>::allocate(int n) {
+  return static_cast<bucket *>(::operator new(sizeof(bucket) * (size_t)n));
+}
+
+template <class Hash>
+void BasicLinearHashDict<Hash>::release(bucket *t, int built) {
+  for (int i=0; i<built; i++) t[i].~bucket();
+  ::operator delete(t);
+}
+
+template <class Hash>
+void BasicLinearHashDict<Hash>::prepare(int buckets) {
+  int n = primes[size_index+1];
+  if (spare==NULL) {
+    spare = allocate(n);
+    spare_built = 0;
+  }
+  for (; buckets>0 && spare_built<n; buckets--, spare_built++) {
+    new (&spare[spare_built]) bucket();
+  }
+}
+
+template <class Hash>
+typename BasicLinearHashDict<Hash>::bucket *BasicLinearHashDict<Hash>::search(bucket *t, int n, uint32_t h, const string &keyID, int &probes,
+                                               int &stop, int &dist) {
+  int i = home(h, n);
+  // Robin Hood keeps every run sorted by distance from home, so once
+  // the entries here are closer to home than we are, ours isn't in
+  // the table.
+  for (dist=0; t[i].key!=NULL && displacement(t, n, i) >= dist; dist++) {
+    probes++;
+    if (t[i].hash==h && t[i].keyID==keyID) return &t[i];
+    i++;
+    if (i==n) i = 0;
+  }
+  probes++; // the bucket that stopped us
+  stop = i;
+  return NULL;
+}
+
+template <class Hash>
+bool BasicLinearHashDict<Hash>::find(PuzzleState *key, PuzzleState *&pred) {
   // Returns true iff the key is found.
   // Returns the associated value in pred
 
-  // Be sure not to keep calling getUniqId() over and over again!
+  return find(key, key->getUniqId(), pred);
+}
 
-  // TODO:  Your code goes here...
-  return true; // Stub:  Delete this when you've implemented the function.
+template <class Hash>
+bool BasicLinearHashDict<Hash>::find(PuzzleState *, const string &keyID, PuzzleState *&pred) {
+  if (old_table!=NULL) migrate(MIGRATE_STEP);
+  uint32_t h = hash(keyID);
+  int probes = 0, stop, dist;
+  bucket *b = search(table, size, h, keyID, probes, stop, dist);
+  // Anything not in the new table yet is still in the old one.
+  if (b==NULL && old_table!=NULL) b = search(old_table, old_size, h, keyID, probes, stop, dist);
+  if (b!=NULL) pred = b->data;
+  probes_stats[(probes < MAX_STATS) ? probes : MAX_STATS-1]++;
+  return b!=NULL;
+}
+
+template <class Hash>
+bool BasicLinearHashDict<Hash>::make_room() {
+  bool moved = (old_table!=NULL);
+  if (moved) migrate(MIGRATE_STEP);
+  else if (incremental && number >= limit/2) prepare(BUILD_STEP);
+  if (number+1 > limit) {
+    rehash();
+    moved = true;
+  }
+  return moved;
 }
 
 // You may assume that no duplicate PuzzleState is ever added.
-void LinearHashDict::add(PuzzleState *key, PuzzleState *pred) {
+template <class Hash>
+void BasicLinearHashDict<Hash>::add(PuzzleState *key, PuzzleState *pred) {
+  string keyID = key->getUniqId();
+  add(key, pred, keyID, hash(keyID));
+}
+
+template <class Hash>
+void BasicLinearHashDict<Hash>::add(PuzzleState *key, PuzzleState *pred, string &keyID) {
+  add(key, pred, keyID, hash(keyID));
+}
+
+template <class Hash>
+void BasicLinearHashDict<Hash>::add(PuzzleState *key, PuzzleState *pred, string &keyID, uint32_t h) {
+  // Only an add() that makes room can be slow, so only those are timed.
+  bool timed = room_needed();
+  chrono::steady_clock::time_point start;
+  if (timed) {
+    start = chrono::steady_clock::now();
+    make_room();
+  }
+  bucket entry;
+  entry.key = key;
+  entry.keyID.swap(keyID);
+  entry.hash = h;
+  entry.data = pred;
+  insert(entry);
+  number++;
+  if (timed) {
+    long took = (long)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    if (took > max_add_ns) max_add_ns = took;
+  }
+}
+
+template <class Hash>
+bool BasicLinearHashDict<Hash>::find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred) {
+  // One id, one hash, one probe sequence.
+  bucket entry;
+  entry.keyID = key->getUniqId();
+  entry.hash = hash(entry.keyID);
+  return resolve(key, pred, entry, found_pred);
+}
+
+template <class Hash>
+bool BasicLinearHashDict<Hash>::find_or_add(PuzzleState *key, PuzzleState *pred, string &keyID, PuzzleState *&found_pred) {
+  bucket entry;
+  entry.keyID.swap(keyID);
+  entry.hash = hash(entry.keyID);
+  return resolve(key, pred, entry, found_pred);
+}
 
-  // TODO:  Your code goes here...
+template <class Hash>
+void BasicLinearHashDict<Hash>::find_or_add_batch(int n, PuzzleState *keys[], PuzzleState *preds[],
+                                       bool found[], PuzzleState *found_preds[]) {
+  // All the hashing first, asking for each home bucket as we go, so
+  // the misses overlap.  A bucket can straddle two cache lines.
+  batch_ids.resize((size_t)n);
+  batch_hashes.resize((size_t)n);
+  for (int i=0; i<n; i++) {
+    batch_ids[i] = keys[i]->getUniqId();
+    batch_hashes[i] = hash(batch_ids[i]);
+    bucket *b = &table[home(batch_hashes[i], size)];
+    __builtin_prefetch(b);
+    __builtin_prefetch((char *)(b+1) - 1);
+  }
+  // By now the first buckets are arriving.  A key that's there has its
+  // keyID compared, which is a miss of its own; ask for that too.
+  for (int i=0; i<n; i++) {
+    int j = home(batch_hashes[i], size);
+    for (int k=0; k<2 && j<size; k++, j++) {
+      if (table[j].key!=NULL && table[j].hash==batch_hashes[i]) {
+        __builtin_prefetch(table[j].keyID.data());
+        break;
+      }
+    }
+  }
+  // If an add grows the table, later prefetches were wasted, no more.
+  bucket entry;
+  for (int i=0; i<n; i++) {
+    entry.keyID.swap(batch_ids[i]);
+    entry.hash = batch_hashes[i];
+    found[i] = resolve(keys[i], preds[i], entry, found_preds[i]);
+  }
 }
 
-#endif 
+template <class Hash>
+bool BasicLinearHashDict<Hash>::resolve(PuzzleState *key, PuzzleState *pred, bucket &entry, PuzzleState *&found_pred) {
+  int probes = 0, stop = 0, dist = 0, old_stop, old_dist;
+  bucket *b = search(table, size, entry.hash, entry.keyID, probes, stop, dist);
+  if (b==NULL && old_table!=NULL) b = search(old_table, old_size, entry.hash, entry.keyID, probes, old_stop, old_dist);
+  probes_stats[(probes < MAX_STATS) ? probes : MAX_STATS-1]++;
+  if (b!=NULL) {
+    found_pred = b->data;
+    return true;
+  }
+
+  // Only a key that's going in makes room.  If that moves buckets, the
+  // insert's place has to be found again.
+  bool timed = room_needed();
+  chrono::steady_clock::time_point start;
+  if (timed) {
+    start = chrono::steady_clock::now();
+    if (make_room()) search(table, size, entry.hash, entry.keyID, probes, stop, dist);
+  }
+  entry.key = key;
+  entry.data = pred;
+  insert(entry, stop, dist);
+  number++;
+  if (timed) {
+    long took = (long)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    if (took > max_add_ns) max_add_ns = took;
+  }
+  return false;
+}
+
+template class BasicLinearHashDict<FNVHash>;
+template class BasicLinearHashDict<PolyHash>;
+template class BasicLinearHashDict<MixHash>;
+template class BasicLinearHashDict<CRCHash>;
+
+#endif
@@ -3,21 +3,70 @@
 #define _LINEARHASHDICT_HPP
 
 #include "PredDict.hpp"
+#include "StatCounter.hpp"
+#include "KeyHash.hpp"
+#include <stdint.h>
+#include <vector>
 
 // An implementation of a dictionary as a hash table with linear probing.
 //
-class LinearHashDict : public PredDict
+// Collisions are resolved Robin Hood style:  when an insert reaches a
+// bucket whose entry is closer to its home bucket than the new key is
+// to its own, the two swap and the displaced entry keeps probing.
+// That evens out probe lengths, so the table can run at a high load,
+// and lets an unsuccessful find() stop as soon as it passes the point
+// where its key would have been put.
+//
+// Normally the table grows all at once, inside the add() that fills
+// it.  With 'incremental' set, growing only allocates the new table;
+// the old one stays beside it, and every add() and find() moves the
+// next MIGRATE_STEP of its buckets across, so no single call pays for
+// the whole move.  (Moving 16 buckets per add empties the old table
+// long before the new one fills.)  Until then, find() looks in both.
+//
+// Hash is the hash function:  one of the policies in KeyHash.hpp, all
+// of which LinearHashDict.cpp instantiates.  Plain LinearHashDict uses
+// FNVHash.
+//
+template <class Hash>
+class BasicLinearHashDict : public PredDict
   {
   public:
-    LinearHashDict();
-    ~LinearHashDict();
+    // max_load is the fraction of buckets allowed to fill before
+    // the table grows.
+    BasicLinearHashDict(double max_load = 0.8, bool incremental = false);
+    ~BasicLinearHashDict();
     bool find(PuzzleState *key, PuzzleState *&pred);
     void add(PuzzleState *key, PuzzleState *pred);
+    // add() of a key whose keyID and hash are already known (h must be
+    // the top half of Hash::hash(keyID)); keyID is taken over.
+    void add(PuzzleState *key, PuzzleState *pred, string &keyID, uint32_t h);
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred);
+    // The same three for a key whose getUniqId() the caller already
+    // has (add() hashes it and calls the one above).  add() and
+    // find_or_add() may take keyID over.
+    bool find(PuzzleState *key, const string &keyID, PuzzleState *&pred);
+    void add(PuzzleState *key, PuzzleState *pred, string &keyID);
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, string &keyID, PuzzleState *&found_pred);
+    // Hashes every key and prefetches its home bucket, then resolves
+    // them in order.
+    void find_or_add_batch(int n, PuzzleState *keys[], PuzzleState *preds[],
+                           bool found[], PuzzleState *found_preds[]);
+
+    int count() { return number; } // how many keys are stored
+    int capacity() { return size; } // how many buckets there are
+    // The slowest add() so far that had to make room (see room_needed()),
+    // in ns.  Only those are timed; the rest just place a key.
+    long longest_add() { return max_add_ns; }
+    // How many find()s so far took i probes (the last counts the rest).
+    int probes(int i) { return probes_stats[(i < MAX_STATS) ? i : MAX_STATS-1]; }
 
   private:
     struct bucket {
       PuzzleState *key; // NULL indicates empty bucket.
       // No need for tombstones, as we never delete.
+      uint32_t hash; // Full hash of keyID:  gives the home bucket, and
+                     // rules out most mismatches without a string compare.
       string keyID; // Avoid recomputation of key's getUniqId()
       PuzzleState *data;
     };
@@ -32,15 +81,69 @@ class LinearHashDict : public PredDict
     int size_index; // index of the current table size in the primes[] array
                     // Invariant:  size == primes[size_index]
     int number; // how many items are currently in hash table
+    double max_load; // largest allowed number/size
+    int limit; // most items the current table may hold
+
+    // The table being emptied into 'table' by an incremental rehash
+    // (NULL if none).  Its buckets below old_next have been moved.
+    bucket *old_table;
+    int old_size;
+    int old_next;
+    bool incremental;
+    const static int MIGRATE_STEP = 16; // old buckets moved per add()/find()
+    // Building the next table's empty buckets takes time too, so an
+    // incremental table builds it ahead, BUILD_STEP buckets per add(),
+    // once it's half way to growing.  'spare' has spare_built buckets
+    // built so far.
+    bucket *spare;
+    int spare_built;
+    const static int BUILD_STEP = 64;
+    long max_add_ns; // the slowest add() so far
+    vector<string> batch_ids; // find_or_add_batch()'s keyIDs...
+    vector<uint32_t> batch_hashes; // ...and their hashes
 
     // The next two variables are just to collect statistics on the
     // number of probes required for each call to find().
-    int *probes_stats; // probe_stats[i] should be how often i probes needed
+    stat_counter *probes_stats; // probe_stats[i] should be how often i probes needed
     const static int MAX_STATS = 20; // How big to make the array.
 
-    int hash(string keyID); // The hash function
+    uint32_t hash(const string &keyID); // The hash function
+    // Maps a hash onto 0..n-1 with a multiply instead of a division.
+    inline int home(uint32_t h, int n) { return (int)(((uint64_t)h * (uint32_t)n) >> 32); }
+    // How far the entry in bucket i of t (of n buckets) sits from its
+    // home bucket.
+    inline int displacement(bucket *t, int n, int i) {
+      int d = i - home(t[i].hash, n);
+      return (d < 0) ? d + n : d;
+    }
+    // Looks for keyID in t (of n buckets), adding the buckets looked
+    // at to probes.  If it's not there, stop and dist are where an
+    // insert would start swapping, and how far that is from home.
+    bucket *search(bucket *t, int n, uint32_t h, const string &keyID, int &probes,
+                   int &stop, int &dist);
+    // Robin Hood insert of an entry known to be new, starting at bucket
+    // i, dist buckets from its home.
+    void insert(bucket &entry, int i, int dist);
+    inline void insert(bucket &entry) { insert(entry, home(entry.hash, size), 0); }
+    // find_or_add() of a key whose keyID and hash are in entry.
+    bool resolve(PuzzleState *key, PuzzleState *pred, bucket &entry, PuzzleState *&found_pred);
+    // Whether an add() has more to do than place its key:  migrating,
+    // building the spare table or growing.
+    inline bool room_needed() {
+      return old_table!=NULL || (incremental && number >= limit/2) || number+1 > limit;
+    }
+    // Does all that.  Returns true if it moved buckets into the table,
+    // so that a search made before is out of date.
+    bool make_room();
+    void migrate(int buckets); // Moves up to that many old buckets over
+    // Tables are allocated raw, so buckets can be built a few at a time.
+    static bucket *allocate(int n);
+    static void release(bucket *t, int built); // destroys built buckets, frees t
+    void prepare(int buckets); // Builds up to that many more spare buckets
     void rehash(); // Resizes to next bigger table and rehashes everything
+                   // (or, if incremental, starts to)
   };
 
-#endif
+typedef BasicLinearHashDict<FNVHash> LinearHashDict;
 
+#endif
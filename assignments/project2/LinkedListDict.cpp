@@ -25,7 +25,7 @@ LinkedListDict::~LinkedListDict() {
   }
 }
 
-bool LinkedListDict::find_helper(node *r, string keyID, PuzzleState *&pred) {
+bool LinkedListDict::find_helper(node *r, const string &keyID, PuzzleState *&pred) {
   while (r!=NULL) {
     if (keyID == r->keyID) {
       pred = r->data; // Got it!  Get the result.
@@ -40,14 +40,35 @@ bool LinkedListDict::find(PuzzleState *key, PuzzleState *&pred) {
   return find_helper(root, key->getUniqId(), pred);
 }
 
+bool LinkedListDict::find(PuzzleState *, const string &keyID, PuzzleState *&pred) {
+  return find_helper(root, keyID, pred);
+}
+
 void LinkedListDict::add(PuzzleState *key, PuzzleState *pred) {
+  string keyID = key->getUniqId();
+  add(key, pred, keyID);
+}
+
+void LinkedListDict::add(PuzzleState *key, PuzzleState *pred, string &keyID) {
   node * temp = new node();
   temp->key = key;
-  temp->keyID = key->getUniqId();
+  temp->keyID.swap(keyID);
   temp->data = pred;
   temp->next = root;
   root = temp;
   return;
 }
 
+bool LinkedListDict::find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred) {
+  // One getUniqId(), kept for the new node if the search fails.
+  string keyID = key->getUniqId();
+  return find_or_add(key, pred, keyID, found_pred);
+}
+
+bool LinkedListDict::find_or_add(PuzzleState *key, PuzzleState *pred, string &keyID, PuzzleState *&found_pred) {
+  if (find_helper(root, keyID, found_pred)) return true;
+  add(key, pred, keyID);
+  return false;
+}
+
 #endif 
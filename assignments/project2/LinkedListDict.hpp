@@ -14,6 +14,12 @@ class LinkedListDict : public PredDict
     ~LinkedListDict();
     bool find(PuzzleState *key, PuzzleState *&pred);
     void add(PuzzleState *key, PuzzleState *pred);
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred);
+    // The same three for a caller that already has key's getUniqId();
+    // a new node keeps keyID (swapped out of the caller's string).
+    bool find(PuzzleState *key, const string &keyID, PuzzleState *&pred);
+    void add(PuzzleState *key, PuzzleState *pred, string &keyID);
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, string &keyID, PuzzleState *&found_pred);
 
   private:
     struct node {
@@ -25,7 +31,7 @@ class LinkedListDict : public PredDict
 
     node *root;
 
-    bool find_helper(node *r, string keyID, PuzzleState *&pred);
+    bool find_helper(node *r, const string &keyID, PuzzleState *&pred);
   };
 
 #endif
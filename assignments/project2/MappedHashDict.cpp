@@ -0,0 +1,369 @@
+#ifndef _MAPPEDHASHDICT_CPP
+#define _MAPPEDHASHDICT_CPP
+
+//MappedHashDict.cpp
+#include "MappedHashDict.hpp"
+#include "KeyHash.hpp"
+#include <cassert>
+#include <cstdio>//for rename
+#include <cstddef>//for offsetof
+#include <cstdlib>//for NULL
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// An implementation of the dictionary ADT as a hash table in a
+// memory-mapped file.
+//
+
+const char MappedHashDict::MAGIC[8] = {'P','R','E','D','D','I','C','T'};
+
+MappedHashDict::MappedHashDict(const string &file, int keys) {
+  path = file;
+  bucket_bytes = (int)((offsetof(bucket, key) + (size_t)keys + 7) & ~(size_t)7);
+  key_bytes = bucket_bytes - (int)offsetof(bucket, key);
+  per_page = PAGE_BYTES / bucket_bytes;
+  pages = 1;
+  limit = (long)(pages * per_page) * 3 / 4;
+  last_pred = NULL;
+  last_pred_number = 0;
+  if (!map_new(path, pages, fd, base)) {
+    cerr << "MappedHashDict: can't make " << path << endl;
+    base = NULL;
+  }
+
+  // Initialize the arrays of counters for probe statistics
+  pages_stats = new int[MAX_STATS]();
+  probes_stats = new int[MAX_STATS]();
+}
+
+MappedHashDict::~MappedHashDict() {
+  for (size_t i=0; i<states.size(); i++) {
+    delete states[i];
+    // Don't delete preds here, to avoid double deletions.
+  }
+  if (base!=NULL) {
+    // The file stays behind, for inspection.
+    munmap(base, (size_t)(PAGE_BYTES + pages*PAGE_BYTES));
+    close(fd);
+  }
+
+  // It's not good style to put this into a destructor,
+  // but it's convenient for this assignment...
+  cout << "Page Statistics for find():\n";
+  for (int i=0; i<MAX_STATS; i++)
+    cout << i << ": " << pages_stats[i] << endl;
+  cout << "Probe Statistics for find():\n";
+  for (int i=0; i<MAX_STATS; i++)
+    cout << i << ": " << probes_stats[i] << endl;
+  delete [] pages_stats;
+  delete [] probes_stats;
+}
+
+uint64_t MappedHashDict::hash(const string &keyID) {
+  // The page and the bucket in it both depend on every character.
+  return FNVHash::hash(keyID);
+}
+
+bool MappedHashDict::map_new(const string &file, uint64_t n, int &new_fd, char *&new_base) {
+  size_t bytes = (size_t)(PAGE_BYTES + n*PAGE_BYTES);
+  new_fd = open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (new_fd < 0) return false;
+  // A file extended with ftruncate() reads as zeros:  all empty buckets.
+  if (ftruncate(new_fd, (off_t)bytes) != 0) {
+    close(new_fd);
+    return false;
+  }
+  void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, new_fd, 0);
+  if (p == MAP_FAILED) {
+    close(new_fd);
+    return false;
+  }
+  new_base = (char *)p;
+  header *h = (header *)new_base;
+  memcpy(h->magic, MAGIC, sizeof(MAGIC));
+  h->version = 1;
+  h->bucket_bytes = (uint32_t)bucket_bytes;
+  h->key_bytes = (uint32_t)key_bytes;
+  h->per_page = (uint32_t)per_page;
+  h->pages = n;
+  h->number = 0;
+  return true;
+}
+
+MappedHashDict::bucket *MappedHashDict::search(uint64_t h, const string &keyID, int &page_count,
+                                               int &probes, bucket *&empty) {
+  // The high half of the hash picks the page, the low half the first
+  // bucket in it.
+  uint64_t page = ((h >> 32) * pages) >> 32;
+  int first = (int)(((h & 0xffffffffu) * (uint64_t)per_page) >> 32);
+  for (uint64_t tried=0; tried<pages; tried++) {
+    page_count++;
+    for (int k=0; k<per_page; k++) {
+      int slot = first + k;
+      if (slot >= per_page) slot -= per_page;
+      bucket *b = at(base, page, slot);
+      probes++;
+      if (b->number == 0) {
+        empty = b;
+        return NULL;
+      }
+      if (b->hash == h && b->length == keyID.length() &&
+          memcmp(b->key, keyID.data(), keyID.length()) == 0) return b;
+    }
+    // This page is full:  on to the next.
+    page++;
+    if (page == pages) page = 0;
+  }
+  empty = NULL; // can't happen:  the table is never full
+  return NULL;
+}
+
+uint32_t MappedHashDict::number_of(PuzzleState *pred) {
+  if (pred == NULL) return 0;
+  if (pred != last_pred) {
+    string keyID = pred->getUniqId();
+    int page_count = 0, probes = 0;
+    bucket *empty;
+    bucket *b = search(hash(keyID), keyID, page_count, probes, empty);
+    last_pred = pred;
+    last_pred_number = (b != NULL) ? b->number : 0;
+  }
+  return last_pred_number;
+}
+
+void MappedHashDict::place(bucket *b, uint64_t h, const string &keyID, PuzzleState *key, PuzzleState *pred) {
+  if ((int)keyID.length() > key_bytes) {
+    cerr << "MappedHashDict: a keyID of " << keyID.length() << " bytes doesn't fit in "
+         << key_bytes << endl;
+    abort();
+  }
+  states.push_back(key);
+  b->hash = h;
+  b->parent = number_of(pred);
+  b->length = (uint16_t)keyID.length();
+  memcpy(b->key, keyID.data(), keyID.length());
+  // The number goes in last:  it's what marks the bucket as used.
+  b->number = (uint32_t)states.size();
+  head()->number = states.size();
+}
+
+void MappedHashDict::rehash() {
+// 221 Students:  DO NOT CHANGE OR DELETE THE NEXT FEW LINES!!!
+// And leave this at the beginning of the rehash() function.
+// We will use this code when marking to be able to watch what
+// your program is doing, so if you change things, we'll mark it wrong.
+#ifdef MARKING_TRACE
+std::cout << "*** REHASHING " << pages*per_page;
+#endif
+// End of "DO NOT CHANGE" Block
+
+  string grown = path + ".grow";
+  int new_fd;
+  char *new_base;
+  if (!map_new(grown, 2*pages, new_fd, new_base)) {
+    cerr << "MappedHashDict: can't make " << grown << endl;
+    abort();
+  }
+
+  // Each bucket moves whole, with the hash it already has.
+  uint64_t old_pages = pages;
+  char *old_base = base;
+  pages = 2*pages;
+  base = new_base;
+  for (uint64_t p=0; p<old_pages; p++) {
+    for (int s=0; s<per_page; s++) {
+      bucket *b = at(old_base, p, s);
+      if (b->number == 0) continue;
+      string keyID(b->key, b->length);
+      int page_count = 0, probes = 0;
+      bucket *empty;
+      search(b->hash, keyID, page_count, probes, empty);
+      memcpy(empty, b, (size_t)bucket_bytes);
+    }
+  }
+  head()->number = states.size();
+  limit = (long)(pages * per_page) * 3 / 4;
+
+  // Only now does the new table take the old one's name.
+  msync(base, (size_t)(PAGE_BYTES + pages*PAGE_BYTES), MS_SYNC);
+  if (rename(grown.c_str(), path.c_str()) != 0) {
+    cerr << "MappedHashDict: can't rename " << grown << endl;
+  }
+  munmap(old_base, (size_t)(PAGE_BYTES + old_pages*PAGE_BYTES));
+  close(fd);
+  fd = new_fd;
+
+// 221 Students:  DO NOT CHANGE OR DELETE THE NEXT FEW LINES!!!
+// And leave this at the end of the rehash() function.
+// We will use this code when marking to be able to watch what
+// your program is doing, so if you change things, we'll mark it wrong.
+#ifdef MARKING_TRACE
+std::cout << " to " << pages*per_page << " ***\n";
+#endif
+// End of "DO NOT CHANGE" Block
+}
+
+bool MappedHashDict::find(PuzzleState *key, PuzzleState *&pred) {
+  // Returns true iff the key is found.
+  // Returns the associated value in pred
+
+  if (base == NULL) return false;
+  string keyID = key->getUniqId();
+  int page_count = 0, probes = 0;
+  bucket *empty;
+  bucket *b = search(hash(keyID), keyID, page_count, probes, empty);
+  if (b != NULL) pred = (b->parent != 0) ? states[b->parent-1] : NULL;
+  pages_stats[(page_count < MAX_STATS) ? page_count : MAX_STATS-1]++;
+  probes_stats[(probes < MAX_STATS) ? probes : MAX_STATS-1]++;
+  return b != NULL;
+}
+
+// You may assume that no duplicate PuzzleState is ever added.
+void MappedHashDict::add(PuzzleState *key, PuzzleState *pred) {
+  PuzzleState *ignored;
+  find_or_add(key, pred, ignored);
+}
+
+bool MappedHashDict::find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred) {
+  if (base == NULL) {
+    cerr << "MappedHashDict: no file to add to" << endl;
+    abort();
+  }
+  string keyID = key->getUniqId();
+  uint64_t h = hash(keyID);
+  int page_count = 0, probes = 0;
+  bucket *empty;
+  bucket *b = search(h, keyID, page_count, probes, empty);
+  pages_stats[(page_count < MAX_STATS) ? page_count : MAX_STATS-1]++;
+  probes_stats[(probes < MAX_STATS) ? probes : MAX_STATS-1]++;
+  if (b != NULL) {
+    found_pred = (b->parent != 0) ? states[b->parent-1] : NULL;
+    return true;
+  }
+  // Only a key that's going in can grow the file.  Growing moves every
+  // bucket, so then look again for where this one goes.
+  if ((long)states.size() + 1 > limit) {
+    rehash();
+    search(h, keyID, page_count, probes, empty);
+  }
+  place(empty, h, keyID, key, pred);
+  return false;
+}
+
+namespace {
+  // keyIDs have tabs and newlines in them; show those as \t and \n.
+  void print_key(ostream &out, const char *key, int length) {
+    for (int i=0; i<length; i++) {
+      if (key[i]=='\t') out << "\\t";
+      else if (key[i]=='\n') out << "\\n";
+      else out << key[i];
+    }
+  }
+}
+
+bool MappedHashDict::inspect(const string &file, ostream &out, bool list) {
+  int f = open(file.c_str(), O_RDONLY);
+  if (f < 0) return false;
+  struct stat st;
+  if (fstat(f, &st) != 0 || st.st_size < PAGE_BYTES) {
+    close(f);
+    return false;
+  }
+  size_t bytes = (size_t)st.st_size;
+  void *p = mmap(NULL, bytes, PROT_READ, MAP_SHARED, f, 0);
+  close(f);
+  if (p == MAP_FAILED) return false;
+  char *file_base = (char *)p;
+  header *h = (header *)file_base;
+  if (memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      bytes < (size_t)(PAGE_BYTES + h->pages*PAGE_BYTES) ||
+      h->per_page == 0 || h->per_page*h->bucket_bytes > (uint32_t)PAGE_BYTES) {
+    munmap(p, bytes);
+    return false;
+  }
+
+  out << file << ":  version " << h->version << ", " << h->pages << " pages of "
+      << h->per_page << " buckets of " << h->bucket_bytes << " bytes (keys up to "
+      << h->key_bytes << "), " << h->number << " keys\n";
+
+  // How many keys sit in their own page, and how full pages are.
+  long found = 0, away = 0, starts = 0;
+  int fill[11] = {0};
+  for (uint64_t page=0; page<h->pages; page++) {
+    int used = 0;
+    for (uint32_t s=0; s<h->per_page; s++) {
+      bucket *b = (bucket *)(file_base + PAGE_BYTES + page*PAGE_BYTES + s*h->bucket_bytes);
+      if (b->number == 0) continue;
+      used++;
+      found++;
+      if (b->parent == 0) starts++;
+      if ((((b->hash >> 32) * h->pages) >> 32) != page) away++;
+      if (list) {
+        out << b->number << "\t" << b->parent << "\t";
+        print_key(out, b->key, b->length);
+        out << endl;
+      }
+    }
+    fill[used * 10 / h->per_page]++;
+  }
+  out << found << " keys found, " << away << " outside their home page, "
+      << starts << " with no predecessor\n";
+  out << "pages by fill:";
+  for (int i=0; i<=10; i++) out << "  " << i*10 << "%:" << fill[i];
+  out << endl;
+
+  munmap(p, bytes);
+  return true;
+}
+
+bool MappedHashDict::trace(const string &file, uint32_t number, ostream &out) {
+  int f = open(file.c_str(), O_RDONLY);
+  if (f < 0) return false;
+  struct stat st;
+  if (fstat(f, &st) != 0 || st.st_size < PAGE_BYTES) {
+    close(f);
+    return false;
+  }
+  size_t bytes = (size_t)st.st_size;
+  void *p = mmap(NULL, bytes, PROT_READ, MAP_SHARED, f, 0);
+  close(f);
+  if (p == MAP_FAILED) return false;
+  char *file_base = (char *)p;
+  header *h = (header *)file_base;
+  if (memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      bytes < (size_t)(PAGE_BYTES + h->pages*PAGE_BYTES)) {
+    munmap(p, bytes);
+    return false;
+  }
+
+  // Buckets aren't in number order, so index them first.
+  vector<bucket *> by_number(h->number + 1, (bucket *)NULL);
+  for (uint64_t page=0; page<h->pages; page++) {
+    for (uint32_t s=0; s<h->per_page; s++) {
+      bucket *b = (bucket *)(file_base + PAGE_BYTES + page*PAGE_BYTES + s*h->bucket_bytes);
+      if (b->number != 0 && b->number < by_number.size()) by_number[b->number] = b;
+    }
+  }
+  bool ok = true;
+  for (size_t steps=0; number != 0; steps++) {
+    if (number >= by_number.size() || by_number[number] == NULL || steps > h->number) {
+      out << number << ":  missing!\n";
+      ok = false;
+      break;
+    }
+    bucket *b = by_number[number];
+    out << number << "\t";
+    print_key(out, b->key, b->length);
+    out << endl;
+    number = b->parent;
+  }
+
+  munmap(p, bytes);
+  return ok;
+}
+
+#endif
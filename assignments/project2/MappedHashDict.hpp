@@ -0,0 +1,116 @@
+//MappedHashDict.hpp
+#ifndef _MAPPEDHASHDICT_HPP
+#define _MAPPEDHASHDICT_HPP
+
+#include "PredDict.hpp"
+#include <stdint.h>
+#include <vector>
+
+// An implementation of a dictionary as a hash table kept in a file,
+// mapped into memory, so that the table can outgrow RAM and the
+// operating system pages it to and from disk (an SSD, ideally).
+//
+// The file is a header page, then pages of fixed-size buckets.  A
+// bucket holds a key's 64-bit hash, its state number (1, 2, ... in
+// the order added; 0 marks an empty bucket), the state number of its
+// predecessor, and its keyID, packed into key_bytes bytes.  So the
+// file by itself records the whole search tree, and is still there to
+// look at (with inspect(), or mapinspect) after the program ends or
+// crashes.
+//
+// Probing stays inside a page:  the hash picks a page and a first
+// bucket in it, and probing wraps around that page before moving on
+// to the next one.  The table as a whole is kept at most 3/4 full.  A
+// single page can still fill up, and then spills into the next, but
+// nearly every page has room, so a lookup nearly always reads one page.
+//
+// To grow, the table is rebuilt, twice the size, in a new file, which
+// is then renamed over the old one.  The file on disk is a complete
+// table at every moment.
+//
+// The PuzzleStates themselves are in memory, as the dictionary owns
+// them; that's one pointer per state here.
+//
+class MappedHashDict : public PredDict
+  {
+  public:
+    // Creates (or empties) the file at 'path'.  Keys longer than
+    // key_bytes can't be added; the default makes 64-byte buckets.
+    MappedHashDict(const string &path, int key_bytes = 46);
+    ~MappedHashDict();
+    bool is_open() { return base!=NULL; } // false if the file couldn't be made
+    bool find(PuzzleState *key, PuzzleState *&pred);
+    void add(PuzzleState *key, PuzzleState *pred);
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred);
+
+    int count() { return (int)states.size(); } // how many keys are stored
+    long capacity() { return (long)pages * per_page; } // how many buckets there are
+
+    // Prints a table file's header and how full and how well spread it
+    // is; with 'list', every entry too (number, predecessor, keyID).
+    // Returns false if it isn't a table file.  Safe to use on the file
+    // of a table still in use, or of a program that crashed.
+    static bool inspect(const string &path, ostream &out, bool list);
+    // Prints the keyIDs from state 'number' back to the start state.
+    static bool trace(const string &path, uint32_t number, ostream &out);
+
+  private:
+    const static int PAGE_BYTES = 4096;
+    const static char MAGIC[8];
+
+    struct header { // the file's first page
+      char magic[8];
+      uint32_t version;
+      uint32_t bucket_bytes;
+      uint32_t key_bytes;
+      uint32_t per_page; // buckets per page
+      uint64_t pages; // pages of buckets, after this one
+      uint64_t number; // keys stored
+    };
+
+    struct bucket { // key[] runs on to the end of the bucket
+      uint64_t hash;
+      uint32_t number; // 0 if empty
+      uint32_t parent; // 0 if none
+      uint16_t length;
+      char key[1];
+    };
+
+    string path;
+    int fd;
+    char *base; // the mapped file
+    uint64_t pages;
+    int per_page;
+    int bucket_bytes;
+    int key_bytes;
+    long limit; // most items the current table may hold
+    vector<PuzzleState*> states; // states[i] is state number i+1
+
+    // The number of the last predecessor looked up:  successors of one
+    // state are added together.
+    PuzzleState *last_pred;
+    uint32_t last_pred_number;
+
+    // Statistics:  pages and buckets looked at per find().
+    int *pages_stats; // pages_stats[i] is how often i pages were needed
+    int *probes_stats; // probes_stats[i] is how often i buckets were
+    const static int MAX_STATS = 20; // How big to make the arrays.
+
+    uint64_t hash(const string &keyID); // The hash function
+    inline header *head() { return (header *)base; }
+    inline bucket *at(char *file, uint64_t page, int slot) {
+      return (bucket *)(file + PAGE_BYTES + page*PAGE_BYTES + (size_t)slot*bucket_bytes);
+    }
+    // Creates a file for a table of n pages, and maps it.
+    bool map_new(const string &file, uint64_t n, int &new_fd, char *&new_base);
+    // Looks for keyID, counting pages and buckets looked at.  If it's
+    // not there, returns NULL and sets empty to where it would go.
+    bucket *search(uint64_t h, const string &keyID, int &page_count, int &probes, bucket *&empty);
+    // The state number of pred, or 0.
+    uint32_t number_of(PuzzleState *pred);
+    // Fills an empty bucket with a new key.
+    void place(bucket *b, uint64_t h, const string &keyID, PuzzleState *key, PuzzleState *pred);
+    void rehash(); // Doubles the pages into a new file and renames it
+  };
+
+#endif
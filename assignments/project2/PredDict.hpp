@@ -41,6 +41,32 @@ class PredDict {
   // Note:  Do not delete the object pointed to by key or pred,
   //        since the dictionary will keep a link to the object.
   virtual void add(PuzzleState *key, PuzzleState *pred) = 0;
+
+  // add the key unless it's already in the dictionary, in one step
+  //
+  // Returns true if it was there:  found_pred is set to its
+  // predecessor, and key is still the caller's to delete.  Returns
+  // false if (key, pred) was added.  This does the work of a find()
+  // and an add() with one search, so dictionaries should override it;
+  // this version just calls the two.
+  virtual bool find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred) {
+    if (find(key, found_pred)) return true;
+    add(key, pred);
+    return false;
+  }
+
+  // find_or_add() for n keys at once
+  //
+  // keys[i] goes with preds[i]; found[i] and found_preds[i] get what
+  // find_or_add() would return for it.  The result is as if the keys
+  // were taken one at a time, in order, but a dictionary can work out
+  // where each one goes first, and have the memory for all of them
+  // fetched together instead of waiting for each in turn.  This
+  // version just takes them one at a time.
+  virtual void find_or_add_batch(int n, PuzzleState *keys[], PuzzleState *preds[],
+                                 bool found[], PuzzleState *found_preds[]) {
+    for (int i=0; i<n; i++) found[i] = find_or_add(keys[i], preds[i], found_preds[i]);
+  }
 };
 
 #endif
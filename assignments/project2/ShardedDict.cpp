@@ -0,0 +1,129 @@
+#ifndef _SHARDEDDICT_CPP
+#define _SHARDEDDICT_CPP
+
+//ShardedDict.cpp
+#include "ShardedDict.hpp"
+#include <cassert>
+#include <chrono>
+#include <cstdlib>//for NULL
+#include <functional>
+#include <iostream>
+#include <mutex>
+
+#include "LinkedListDict.hpp"
+#include "AVLDict.hpp"
+#include "LinearHashDict.hpp"
+#include "DoubleHashDict.hpp"
+#include "SwissHashDict.hpp"
+#include "CuckooHashDict.hpp"
+
+// A dictionary ADT split into independently locked shards.
+//
+
+static inline long now_ns() {
+  return (long)chrono::duration_cast<chrono::nanoseconds>(
+    chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <class Dict>
+ShardedDict<Dict>::ShardedDict(int n, bool mostly) : count(n), read_mostly(mostly) {
+  dicts = new Dict[count];
+  shards = new shard[count];
+  for (int i=0; i<count; i++) {
+    shards[i].acquisitions = 0;
+    shards[i].waits = 0;
+    shards[i].hold_ns = 0;
+    shards[i].max_hold_ns = 0;
+    shards[i].shared_acquisitions.store(0);
+  }
+}
+
+template <class Dict>
+ShardedDict<Dict>::~ShardedDict() {
+  // Each shard deletes its own keys.
+  delete [] dicts;
+
+  // It's not good style to put this into a destructor,
+  // but it's convenient for this assignment...
+  cout << "Lock Statistics per shard (taken, waited, shared, mean ns held, max ns held):\n";
+  for (int i=0; i<count; i++) {
+    shard &s = shards[i];
+    cout << i << ": " << s.acquisitions << " " << s.waits << " "
+         << s.shared_acquisitions.load() << " "
+         << (s.acquisitions ? s.hold_ns / s.acquisitions : 0) << " "
+         << s.max_hold_ns << endl;
+  }
+  delete [] shards;
+}
+
+template <class Dict>
+int ShardedDict<Dict>::pick(const string &keyID) {
+  // The top half of the hash, scaled to 0..count-1; the wrapped
+  // dictionary uses its own hash, so it doesn't matter that every key
+  // in a shard agrees here.
+  uint64_t h = (uint64_t)std::hash<string>()(keyID);
+  return (int)(((h >> 32) * (uint64_t)count) >> 32);
+}
+
+template <class Dict>
+long ShardedDict<Dict>::lock(shard &s) {
+  if (!s.lock.try_lock()) {
+    s.lock.lock();
+    s.waits++;
+  }
+  s.acquisitions++;
+  return now_ns();
+}
+
+template <class Dict>
+void ShardedDict<Dict>::unlock(shard &s, long since) {
+  long held = now_ns() - since;
+  s.hold_ns += held;
+  if (held > s.max_hold_ns) s.max_hold_ns = held;
+  s.lock.unlock();
+}
+
+template <class Dict>
+bool ShardedDict<Dict>::find(PuzzleState *key, PuzzleState *&pred) {
+  string keyID = key->getUniqId();
+  int i = pick(keyID);
+  shard &s = shards[i];
+  if (read_mostly) {
+    shared_lock<shared_mutex> reading(s.lock);
+    s.shared_acquisitions.fetch_add(1, memory_order_relaxed);
+    return dicts[i].find(key, keyID, pred);
+  }
+  long since = lock(s);
+  bool found = dicts[i].find(key, keyID, pred);
+  unlock(s, since);
+  return found;
+}
+
+// You may assume that no duplicate PuzzleState is ever added.
+template <class Dict>
+void ShardedDict<Dict>::add(PuzzleState *key, PuzzleState *pred) {
+  string keyID = key->getUniqId();
+  int i = pick(keyID);
+  long since = lock(shards[i]);
+  dicts[i].add(key, pred, keyID);
+  unlock(shards[i], since);
+}
+
+template <class Dict>
+bool ShardedDict<Dict>::find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred) {
+  string keyID = key->getUniqId();
+  int i = pick(keyID);
+  long since = lock(shards[i]);
+  bool found = dicts[i].find_or_add(key, pred, keyID, found_pred);
+  unlock(shards[i], since);
+  return found;
+}
+
+template class ShardedDict<LinkedListDict>;
+template class ShardedDict<AVLDict>;
+template class ShardedDict<LinearHashDict>;
+template class ShardedDict<DoubleHashDict>;
+template class ShardedDict<SwissHashDict>;
+template class ShardedDict<CuckooHashDict>;
+
+#endif
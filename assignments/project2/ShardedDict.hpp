@@ -0,0 +1,74 @@
+//ShardedDict.hpp
+#ifndef _SHARDEDDICT_HPP
+#define _SHARDEDDICT_HPP
+
+#include "PredDict.hpp"
+#include <atomic>
+#include <shared_mutex>
+#include <stdint.h>
+
+// A dictionary for several threads at once, made of any number of
+// copies ("shards") of another PredDict, each behind its own lock.  A
+// key's hash picks its shard, so threads only wait for each other when
+// they want the same shard at the same time.
+//
+// Dict is any PredDict with a default constructor, and find(), add()
+// and find_or_add() overloads that take the key's getUniqId() (which
+// picking the shard needs, so it's only made once).  ShardedDict.cpp
+// instantiates it for the dictionaries in this project.
+//
+// Each shard counts how often its lock was taken, how often a thread
+// had to wait for it, and how long it was held (total and longest);
+// the destructor prints them.
+//
+// With read_mostly set, find() takes its shard's lock shared, so finds
+// in one shard run side by side and only add() excludes them.  That is
+// only sound if Dict::find() doesn't write, or writes only atomics:
+// the hash tables and AVLDict bump their probe statistics in find(),
+// so those are stat_counters (StatCounter.hpp), and can come out a
+// little low in this mode.  LinearHashDict and DoubleHashDict also
+// migrate in find() when growing incrementally, which the shards,
+// default-constructed, never do.  (Finds that don't lock at all,
+// in the style of a sequence lock, would be wrong here:  the wrapped
+// dictionaries free their old tables or nodes while growing, under a
+// reader that isn't holding anything.)
+//
+template <class Dict>
+class ShardedDict : public PredDict
+  {
+  public:
+    ShardedDict(int shards = 16, bool read_mostly = false);
+    ~ShardedDict();
+    bool find(PuzzleState *key, PuzzleState *&pred);
+    void add(PuzzleState *key, PuzzleState *pred);
+
+    // Adds key unless an equal state is already there, as one step.
+    // Returns true if it was there:  then found_pred is set to its
+    // predecessor, and the caller still owns key.  Returns false if
+    // key was added.
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred);
+
+  private:
+    // Shards sit on their own cache lines, so that threads using
+    // neighbouring shards don't slow each other down.
+    struct alignas(64) shard {
+      shared_mutex lock;
+      // Written only while holding the lock exclusively.
+      long acquisitions; // exclusive acquisitions
+      long waits; // ... that found the lock taken
+      long hold_ns; // total time held
+      long max_hold_ns; // longest time held
+      atomic<long> shared_acquisitions; // shared acquisitions
+    };
+
+    int count; // number of shards
+    bool read_mostly;
+    Dict *dicts;
+    shard *shards;
+
+    int pick(const string &keyID); // Which shard a key lives in
+    long lock(shard &s); // Takes s.lock; returns the time it was taken
+    void unlock(shard &s, long since); // Releases it, recording the hold time
+  };
+
+#endif
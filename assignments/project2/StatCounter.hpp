@@ -0,0 +1,25 @@
+//StatCounter.hpp
+#ifndef _STATCOUNTER_HPP
+#define _STATCOUNTER_HPP
+
+#include <atomic>
+using namespace std;
+
+// A statistics counter that find() can bump while other threads run
+// find() on the same dictionary (as ShardedDict's read_mostly mode
+// lets them).  A bump is a relaxed load and a relaxed store, which
+// compile to the same instructions as a plain ++, not a locked
+// increment; so it's no slower, and never a data race, but two bumps
+// at the same moment can count as one.
+class stat_counter
+  {
+  public:
+    stat_counter() : n(0) { }
+    void operator++(int) { n.store(n.load(memory_order_relaxed) + 1, memory_order_relaxed); }
+    operator int() const { return n.load(memory_order_relaxed); }
+
+  private:
+    atomic<int> n;
+  };
+
+#endif
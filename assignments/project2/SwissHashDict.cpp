@@ -0,0 +1,221 @@
+#ifndef _SWISSHASHDICT_CPP
+#define _SWISSHASHDICT_CPP
+
+//SwissHashDict.cpp
+#include "SwissHashDict.hpp"
+#include "KeyHash.hpp"
+#include <cassert>
+#include <cstdlib>//for NULL
+#include <cstring>
+#include <iostream>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// An implementation of a dictionary ADT as a hash table probed 16
+// buckets at a time.
+//
+
+SwissHashDict::SwissHashDict() {
+  allocate(64);
+  number = 0;
+
+  // Initialize the array of counters for probe statistics
+  probes_stats = new stat_counter[MAX_STATS];
+}
+
+SwissHashDict::~SwissHashDict() {
+  // Delete all table entries...
+  for (int i=0; i<size; i++) {
+    if (control[i]!=EMPTY) {
+      delete table[i].key;
+      // Don't delete data here, to avoid double deletions.
+    }
+  }
+  // Delete the table itself
+  delete [] table;
+  delete [] control;
+
+  // It's not good style to put this into a destructor,
+  // but it's convenient for this assignment...
+  cout << "Probe Statistics for find():\n";
+  for (int i=0; i<MAX_STATS; i++)
+    cout << i << ": " << probes_stats[i] << endl;
+  delete [] probes_stats;
+}
+
+uint64_t SwissHashDict::hash(const string &keyID) {
+  // The tag and the group number both depend on every character.
+  return FNVHash::hash(keyID);
+}
+
+void SwissHashDict::allocate(int buckets) {
+  size = buckets;
+  control = new uint8_t[size + GROUP_SIZE-1];
+  memset(control, EMPTY, size + GROUP_SIZE-1);
+  table = new bucket[size]();
+  limit = size / 8 * 7;
+}
+
+void SwissHashDict::set_control(int i, uint8_t byte) {
+  control[i] = byte;
+  if (i < GROUP_SIZE-1) control[size + i] = byte;
+}
+
+uint32_t SwissHashDict::match(int pos, uint8_t byte) {
+  const uint8_t *group = control + pos;
+#if defined(__SSE2__)
+  __m128i bytes = _mm_loadu_si128((const __m128i *)group);
+  return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)byte)));
+#else
+  uint32_t bits = 0;
+  for (int i=0; i<GROUP_SIZE; i++) {
+    if (group[i]==byte) bits |= 1u << i;
+  }
+  return bits;
+#endif
+}
+
+void SwissHashDict::insert(uint64_t h, PuzzleState *key, string &keyID, PuzzleState *data) {
+  // Groups are visited at 0, 1, 3, 6, 10, ... groups' distance from
+  // the first, which, with a power-of-two size, covers every bucket.
+  int pos = first_group(h);
+  for (int step=1; ; step++) {
+    uint32_t empty = match(pos, EMPTY);
+    if (empty) {
+      place((pos + __builtin_ctz(empty)) & (size-1), h, key, keyID, data);
+      return;
+    }
+    pos = (pos + step * GROUP_SIZE) & (size-1);
+  }
+}
+
+void SwissHashDict::place(int i, uint64_t h, PuzzleState *key, string &keyID, PuzzleState *data) {
+  set_control(i, tag(h));
+  table[i].key = key;
+  table[i].keyID.swap(keyID);
+  table[i].data = data;
+}
+
+void SwissHashDict::rehash() {
+  uint8_t *old_control = control;
+  bucket *old_table = table;
+  int old_size = size;
+
+  allocate(2 * size);
+
+  // Buckets don't keep the hash (they're small enough as it is), so
+  // hash the saved keyID again; getUniqId() isn't called.
+  for (int i=0; i<old_size; i++) {
+    if (old_control[i]!=EMPTY) {
+      insert(hash(old_table[i].keyID), old_table[i].key, old_table[i].keyID, old_table[i].data);
+    }
+  }
+  delete [] old_table;
+  delete [] old_control;
+}
+
+bool SwissHashDict::find(PuzzleState *key, PuzzleState *&pred) {
+  // Returns true iff the key is found.
+  // Returns the associated value in pred
+
+  return find(key, key->getUniqId(), pred);
+}
+
+bool SwissHashDict::find(PuzzleState *, const string &keyID, PuzzleState *&pred) {
+  int probes = 1, empty;
+  bucket *b = search(hash(keyID), keyID, probes, empty);
+  if (b!=NULL) pred = b->data;
+  probes_stats[(probes < MAX_STATS) ? probes : MAX_STATS-1]++;
+  return b!=NULL;
+}
+
+SwissHashDict::bucket *SwissHashDict::search(uint64_t h, const string &keyID, int &probes, int &empty) {
+  uint8_t t = tag(h);
+  int pos = first_group(h);
+  for (int step=1; ; step++) {
+    for (uint32_t hits = match(pos, t); hits!=0; hits &= hits-1) {
+      bucket &b = table[(pos + __builtin_ctz(hits)) & (size-1)];
+      if (b.keyID==keyID) return &b;
+    }
+    // We never delete, so an EMPTY bucket means the key would have
+    // been put here.
+    uint32_t free = match(pos, EMPTY);
+    if (free) {
+      empty = (pos + __builtin_ctz(free)) & (size-1);
+      return NULL;
+    }
+    pos = (pos + step * GROUP_SIZE) & (size-1);
+    probes++;
+  }
+}
+
+// You may assume that no duplicate PuzzleState is ever added.
+void SwissHashDict::add(PuzzleState *key, PuzzleState *pred) {
+  string keyID = key->getUniqId();
+  add(key, pred, keyID);
+}
+
+void SwissHashDict::add(PuzzleState *key, PuzzleState *pred, string &keyID) {
+  if (number+1 > limit) rehash();
+  insert(hash(keyID), key, keyID, pred);
+  number++;
+}
+
+bool SwissHashDict::find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred) {
+  string keyID = key->getUniqId();
+  return resolve(key, pred, keyID, hash(keyID), found_pred);
+}
+
+bool SwissHashDict::find_or_add(PuzzleState *key, PuzzleState *pred, string &keyID, PuzzleState *&found_pred) {
+  return resolve(key, pred, keyID, hash(keyID), found_pred);
+}
+
+void SwissHashDict::find_or_add_batch(int n, PuzzleState *keys[], PuzzleState *preds[],
+                                      bool found[], PuzzleState *found_preds[]) {
+  // All the hashing first, asking for each first group's control
+  // bytes as we go, so the misses overlap.  Then, as they arrive, the
+  // bucket of the first tag match, and then its keyID:  a state that
+  // has been seen (most are) costs those two misses more.
+  batch_ids.resize((size_t)n);
+  batch_hashes.resize((size_t)n);
+  for (int i=0; i<n; i++) {
+    batch_ids[i] = keys[i]->getUniqId();
+    batch_hashes[i] = hash(batch_ids[i]);
+    __builtin_prefetch(&control[first_group(batch_hashes[i])]);
+  }
+  for (int i=0; i<n; i++) {
+    int pos = first_group(batch_hashes[i]);
+    uint32_t hits = match(pos, tag(batch_hashes[i]));
+    if (hits) __builtin_prefetch(&table[(pos + __builtin_ctz(hits)) & (size-1)]);
+  }
+  for (int i=0; i<n; i++) {
+    int pos = first_group(batch_hashes[i]);
+    uint32_t hits = match(pos, tag(batch_hashes[i]));
+    if (hits) __builtin_prefetch(table[(pos + __builtin_ctz(hits)) & (size-1)].keyID.data());
+  }
+  for (int i=0; i<n; i++) {
+    found[i] = resolve(keys[i], preds[i], batch_ids[i], batch_hashes[i], found_preds[i]);
+  }
+}
+
+bool SwissHashDict::resolve(PuzzleState *key, PuzzleState *pred, string &keyID, uint64_t h, PuzzleState *&found_pred) {
+  int probes = 1, empty;
+  bucket *b = search(h, keyID, probes, empty);
+  probes_stats[(probes < MAX_STATS) ? probes : MAX_STATS-1]++;
+  if (b!=NULL) {
+    found_pred = b->data;
+    return true;
+  }
+  // Only a key that's going in can grow the table.  Growing moves
+  // every bucket, so then look again for where this one goes.
+  if (number+1 > limit) {
+    rehash();
+    search(h, keyID, probes, empty);
+  }
+  place(empty, h, key, keyID, pred);
+  number++;
+  return false;
+}
+
+#endif
@@ -0,0 +1,94 @@
+//SwissHashDict.hpp
+#ifndef _SWISSHASHDICT_HPP
+#define _SWISSHASHDICT_HPP
+
+#include "PredDict.hpp"
+#include "StatCounter.hpp"
+#include <stdint.h>
+#include <vector>
+
+// An implementation of a dictionary as an open-addressing hash table
+// that probes a group of 16 buckets at a time.
+//
+// Beside the buckets is an array of control bytes, one per bucket:
+// EMPTY, or 7 bits of the key's hash (its "tag").  A probe loads the
+// 16 control bytes of a group and compares them all with the tag at
+// once, so only buckets whose tag matches are looked at, and a group
+// with any EMPTY byte ends an unsuccessful search.  That keeps probes
+// short even at 7/8 full, which is as full as the table gets.
+//
+// A group is any 16 consecutive buckets, starting where the hash
+// says, not one of a fixed set of blocks:  with fixed blocks, every
+// block that fills up pushes all its later keys elsewhere, and at 7/8
+// full a lot of blocks are full.  So that a group can run off the end
+// of the table, the first 15 control bytes are copied after the last.
+//
+class SwissHashDict : public PredDict
+  {
+  public:
+    SwissHashDict();
+    ~SwissHashDict();
+    bool find(PuzzleState *key, PuzzleState *&pred);
+    void add(PuzzleState *key, PuzzleState *pred);
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, PuzzleState *&found_pred);
+    // find(), add() and find_or_add() of a key whose keyID is already
+    // made; a key that goes in takes it over.
+    bool find(PuzzleState *key, const string &keyID, PuzzleState *&pred);
+    void add(PuzzleState *key, PuzzleState *pred, string &keyID);
+    bool find_or_add(PuzzleState *key, PuzzleState *pred, string &keyID, PuzzleState *&found_pred);
+    // Hashes every key and prefetches its first group's control bytes
+    // and bucket, then resolves them in order.
+    void find_or_add_batch(int n, PuzzleState *keys[], PuzzleState *preds[],
+                           bool found[], PuzzleState *found_preds[]);
+
+    int count() { return number; } // how many keys are stored
+    int capacity() { return size; } // how many buckets there are
+
+  private:
+    struct bucket {
+      PuzzleState *key;
+      string keyID; // Avoid recomputation of key's getUniqId()
+      PuzzleState *data;
+    };
+
+    const static int GROUP_SIZE = 16; // buckets per probe (one SSE2 register)
+    const static uint8_t EMPTY = 0x80; // control byte of an empty bucket
+
+    uint8_t *control; // one byte per bucket:  EMPTY or the key's tag,
+                      // then copies of the first GROUP_SIZE-1 bytes
+    bucket *table;
+    int size; // number of buckets; always a power of two
+    int number; // how many items are currently in hash table
+    int limit; // most items the current table may hold (7/8 of it)
+    vector<string> batch_ids; // find_or_add_batch()'s keyIDs...
+    vector<uint64_t> batch_hashes; // ...and their hashes
+
+    // The next two variables are just to collect statistics on the
+    // number of probes required for each call to find().  Here a
+    // probe is one group of 16 buckets.
+    stat_counter *probes_stats; // probe_stats[i] should be how often i probes needed
+    const static int MAX_STATS = 20; // How big to make the array.
+
+    uint64_t hash(const string &keyID); // The hash function
+    // The tag is the low 7 bits of the hash; the first group comes
+    // from the rest.
+    inline uint8_t tag(uint64_t h) { return (uint8_t)(h & 0x7f); }
+    inline int first_group(uint64_t h) { return (int)((h >> 7) & (uint64_t)(size-1)); }
+    // Bit i set if control byte pos+i equals 'byte'.
+    uint32_t match(int pos, uint8_t byte);
+    // Sets the control byte of bucket i (and its copy, if it has one).
+    void set_control(int i, uint8_t byte);
+    void allocate(int buckets); // a new, empty table
+    // Puts a key known to be new into the first free bucket.
+    void insert(uint64_t h, PuzzleState *key, string &keyID, PuzzleState *data);
+    // Looks for keyID, counting groups looked at in probes.  If it's
+    // not there, empty is the bucket insert() would put it in.
+    bucket *search(uint64_t h, const string &keyID, int &probes, int &empty);
+    void place(int i, uint64_t h, PuzzleState *key, string &keyID, PuzzleState *data);
+    // find_or_add() of a key whose keyID and hash are known; keyID is
+    // taken over if the key is added.
+    bool resolve(PuzzleState *key, PuzzleState *pred, string &keyID, uint64_t h, PuzzleState *&found_pred);
+    void rehash(); // Doubles the number of buckets and rehashes everything
+  };
+
+#endif
@@ -0,0 +1,185 @@
+/*
+  concurrentbench.cpp: contains 'main' function.
+
+  concurrentbench [keys] [max threads]
+      First a stress test:  every thread offers every key to one
+      ConcurrentHashDict with find_or_add(), in its own order, and we
+      check that each key was added exactly once and can be found with
+      the right predecessor.  Then a throughput test:  with 1, 2, 4, ...
+      threads, each key is offered twice (as a search finds most states
+      again), compared with a LinearHashDict behind one mutex and with
+      16 LinearHashDict shards behind a lock each (ShardedDict), and
+      with the same shards in read-mostly mode, where each key is
+      looked for with find() first (a shared lock) and only offered
+      to find_or_add() if it isn't there.
+      Defaults:  200000 keys, all hardware threads.
+*/
+
+#include <iostream>
+#include <sstream>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PuzzleState.hpp"
+#include "BenchKeys.hpp"
+#include "ConcurrentHashDict.hpp"
+#include "LinearHashDict.hpp"
+#include "ShardedDict.hpp"
+
+using namespace std;
+
+typedef chrono::steady_clock bench_clock;
+
+// The predecessor we record for key i, so we can check it comes back.
+PuzzleState *tag_for(int i) { return (PuzzleState *)(uintptr_t)(8*(i+1)); }
+
+void stress_worker(ConcurrentHashDict *dict, const vector<string> *keys,
+                   int thread, atomic<int> *adds, vector<int> *added_by) {
+  int n = (int)keys->size();
+  // Each thread starts somewhere else and strides differently, so
+  // threads collide on the same keys at different times.
+  int stride = 2*thread + 1;
+  while (n % stride == 0) stride += 2;
+  for (int j=0; j<n; j++) {
+    int i = (int)(((long)j * stride + (long)thread * 7919) % n);
+    KeyState *key = new KeyState((*keys)[i]);
+    PuzzleState *pred;
+    if (dict->find_or_add(key, tag_for(i), pred)) {
+      delete key;
+      if (pred != tag_for(i)) cerr << "concurrentbench: wrong predecessor!" << endl;
+    } else {
+      adds->fetch_add(1);
+      (*added_by)[i] = thread;
+    }
+  }
+}
+
+bool stress(const vector<string> &keys, int threads) {
+  ConcurrentHashDict dict;
+  atomic<int> adds(0);
+  vector<int> added_by(keys.size(), -1);
+  vector<thread> workers;
+  for (int t=0; t<threads; t++) {
+    workers.push_back(thread(stress_worker, &dict, &keys, t, &adds, &added_by));
+  }
+  for (int t=0; t<threads; t++) workers[t].join();
+
+  bool ok = (adds.load() == (int)keys.size()) && (dict.count() == (int)keys.size());
+  for (size_t i=0; i<keys.size(); i++) {
+    KeyState key(keys[i]);
+    PuzzleState *pred = NULL;
+    if (!dict.find(&key, pred) || pred != tag_for((int)i) || added_by[i] < 0) ok = false;
+  }
+  cout << "stress, " << threads << " threads:  " << adds.load() << " adds of "
+       << keys.size() << " keys in " << dict.tables() << " tables:  "
+       << (ok ? "ok" : "FAILED") << endl;
+  return ok;
+}
+
+// Offers keys[first..last) twice to dict (find_or_add)...
+void concurrent_worker(ConcurrentHashDict *dict, const vector<string> *keys, int first, int last) {
+  for (int round=0; round<2; round++) {
+    for (int i=first; i<last; i++) {
+      KeyState *key = new KeyState((*keys)[i]);
+      PuzzleState *pred;
+      if (dict->find_or_add(key, NULL, pred)) delete key;
+    }
+  }
+}
+
+// ...or to a LinearHashDict, with find then add under one lock.
+void locked_worker(LinearHashDict *dict, mutex *lock, const vector<string> *keys, int first, int last) {
+  for (int round=0; round<2; round++) {
+    for (int i=first; i<last; i++) {
+      KeyState *key = new KeyState((*keys)[i]);
+      PuzzleState *pred;
+      lock->lock();
+      bool found = dict->find(key, pred);
+      if (!found) dict->add(key, NULL);
+      lock->unlock();
+      if (found) delete key;
+    }
+  }
+}
+
+// ...or to a ShardedDict.
+void sharded_worker(ShardedDict<LinearHashDict> *dict, const vector<string> *keys, int first, int last) {
+  for (int round=0; round<2; round++) {
+    for (int i=first; i<last; i++) {
+      KeyState *key = new KeyState((*keys)[i]);
+      PuzzleState *pred;
+      if (dict->find_or_add(key, NULL, pred)) delete key;
+    }
+  }
+}
+
+// ...or to a read-mostly ShardedDict, trying a shared find() first.
+void read_mostly_worker(ShardedDict<LinearHashDict> *dict, const vector<string> *keys, int first, int last) {
+  for (int round=0; round<2; round++) {
+    for (int i=first; i<last; i++) {
+      KeyState *key = new KeyState((*keys)[i]);
+      PuzzleState *pred;
+      if (dict->find(key, pred) || dict->find_or_add(key, NULL, pred)) delete key;
+    }
+  }
+}
+
+enum kind { LOCK_FREE, ONE_LOCK, SHARDED, READ_MOSTLY };
+
+// Millions of operations per second.
+double throughput(const vector<string> &keys, int threads, kind which) {
+  int n = (int)keys.size();
+  ostringstream sink; // LinearHashDict prints its statistics; don't.
+  streambuf *saved = cout.rdbuf(sink.rdbuf());
+  ConcurrentHashDict *concurrent = new ConcurrentHashDict();
+  LinearHashDict *linear = new LinearHashDict();
+  ShardedDict<LinearHashDict> *sharded = new ShardedDict<LinearHashDict>(16, which==READ_MOSTLY);
+  mutex lock;
+
+  bench_clock::time_point start = bench_clock::now();
+  vector<thread> workers;
+  for (int t=0; t<threads; t++) {
+    int first = (int)((long)n * t / threads);
+    int last = (int)((long)n * (t+1) / threads);
+    if (which==ONE_LOCK) workers.push_back(thread(locked_worker, linear, &lock, &keys, first, last));
+    else if (which==SHARDED) workers.push_back(thread(sharded_worker, sharded, &keys, first, last));
+    else if (which==READ_MOSTLY) workers.push_back(thread(read_mostly_worker, sharded, &keys, first, last));
+    else workers.push_back(thread(concurrent_worker, concurrent, &keys, first, last));
+  }
+  for (int t=0; t<threads; t++) workers[t].join();
+  chrono::duration<double, micro> elapsed = bench_clock::now() - start;
+
+  delete concurrent;
+  delete linear;
+  delete sharded;
+  cout.rdbuf(saved);
+  return 2.0 * n / elapsed.count();
+}
+
+int main(int argc, char *argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 200000;
+  int max_threads = (argc > 2) ? atoi(argv[2]) : (int)thread::hardware_concurrency();
+  if (max_threads < 1) max_threads = 1;
+
+  vector<string> keys = make_slider_keys(n, 4, 4, 221u);
+
+  bool ok = true;
+  for (int threads=1; threads<=max_threads; threads*=2) ok = stress(keys, threads) && ok;
+  if (max_threads > 1 && (max_threads & (max_threads-1))) ok = stress(keys, max_threads) && ok;
+
+  cout << "threads\tlock-free Mops/s\tone mutex Mops/s\tsharded Mops/s\tread-mostly Mops/s\n";
+  for (int threads=1; ; threads*=2) {
+    if (threads > max_threads) threads = max_threads;
+    cout << threads << "\t" << throughput(keys, threads, LOCK_FREE) << "\t\t\t"
+         << throughput(keys, threads, ONE_LOCK) << "\t\t\t"
+         << throughput(keys, threads, SHARDED) << "\t\t"
+         << throughput(keys, threads, READ_MOSTLY) << endl;
+    if (threads == max_threads) break;
+  }
+  return ok ? 0 : 1;
+}
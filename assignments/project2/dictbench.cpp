@@ -0,0 +1,270 @@
+/*
+  dictbench.cpp: contains 'main' function.
+
+  dictbench [keys]
+      Fills LinearHashDict and DoubleHashDict to load factors from 0.5
+      to 0.9 with 4x4 SliderPuzzle ids, and times add(), find() of keys
+      that are present, and find() of keys that aren't.  The tables are
+      grown to at least 'keys' buckets first (default 393241), then
+      filled without further growth, so each row compares the two
+      tables at exactly the same load.
+      Then it adds the same keys to tables that start small, growing
+      all at once or incrementally, and reports the slowest add().
+      Then it times the ordered dictionaries, AVLDict and BTreeDict,
+      on the same keys, and BTreeDict's bulk_load().
+      Last, it fills LinearHashDict, DoubleHashDict and SwissHashDict
+      with the keys, and offers half of them again, shuffled, through
+      find_or_add_batch(), in batches of 1 to 64.
+*/
+
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "PuzzleState.hpp"
+#include "BenchKeys.hpp"
+#include "LinearHashDict.hpp"
+#include "DoubleHashDict.hpp"
+#include "AVLDict.hpp"
+#include "BTreeDict.hpp"
+#include "SwissHashDict.hpp"
+
+using namespace std;
+
+typedef chrono::steady_clock bench_clock;
+
+// No growth once the table is big enough:  loads stay below this.
+const double FILL_LIMIT = 0.95;
+
+// Nanoseconds per operation for add, successful and unsuccessful find.
+struct timings {
+  double add, hit, miss;
+  int capacity;
+};
+
+template <class Dict>
+timings run(double load, int min_size, const vector<string> &keys,
+            const vector<KeyState*> &present, const vector<KeyState*> &absent) {
+  timings t;
+  // The destructor prints its probe statistics; don't.
+  ostringstream sink;
+  streambuf *saved = cout.rdbuf(sink.rdbuf());
+  {
+    Dict dict(FILL_LIMIT);
+    // Grow to size first, untimed.
+    size_t next = 0;
+    while (dict.capacity() < min_size) {
+      dict.add(new KeyState(keys[next]), NULL);
+      next++;
+    }
+    int target = (int)(load * dict.capacity());
+    size_t first = next;
+
+    bench_clock::time_point start = bench_clock::now();
+    while (dict.count() < target) {
+      dict.add(new KeyState(keys[next]), NULL);
+      next++;
+    }
+    chrono::duration<double, nano> elapsed = bench_clock::now() - start;
+    t.add = elapsed.count() / (double)(next - first);
+
+    PuzzleState *pred;
+    int found = 0;
+    start = bench_clock::now();
+    for (size_t i=0; i<next; i++) found += dict.find(present[i], pred);
+    elapsed = bench_clock::now() - start;
+    t.hit = elapsed.count() / (double)next;
+    if (found != (int)next) cerr << "dictbench: lost keys!" << endl;
+
+    found = 0;
+    start = bench_clock::now();
+    for (size_t i=0; i<next; i++) found += dict.find(absent[i], pred);
+    elapsed = bench_clock::now() - start;
+    t.miss = elapsed.count() / (double)next;
+    if (found != 0) cerr << "dictbench: found keys that were never added!" << endl;
+
+    t.capacity = dict.capacity();
+  }
+  cout.rdbuf(saved);
+  return t;
+}
+
+// The slowest add() while adding every key, in milliseconds.
+template <class Dict>
+double longest_add(bool incremental, const vector<string> &keys) {
+  ostringstream sink;
+  streambuf *saved = cout.rdbuf(sink.rdbuf());
+  long longest;
+  {
+    Dict dict(0.8, incremental);
+    for (size_t i=0; i<keys.size(); i++) dict.add(new KeyState(keys[i]), NULL);
+    longest = dict.longest_add();
+  }
+  cout.rdbuf(saved);
+  return (double)longest / 1e6;
+}
+
+// Times both kinds of find() on a dictionary that holds 'present'.
+template <class Dict>
+void time_finds(Dict &dict, const vector<KeyState*> &present,
+                const vector<KeyState*> &absent, timings &t) {
+  size_t n = present.size();
+  PuzzleState *pred;
+  int found = 0;
+  bench_clock::time_point start = bench_clock::now();
+  for (size_t i=0; i<n; i++) found += dict.find(present[i], pred);
+  chrono::duration<double, nano> elapsed = bench_clock::now() - start;
+  t.hit = elapsed.count() / (double)n;
+  if (found != (int)n) cerr << "dictbench: lost keys!" << endl;
+
+  found = 0;
+  start = bench_clock::now();
+  for (size_t i=0; i<n; i++) found += dict.find(absent[i], pred);
+  elapsed = bench_clock::now() - start;
+  t.miss = elapsed.count() / (double)n;
+  if (found != 0) cerr << "dictbench: found keys that were never added!" << endl;
+}
+
+// Adds every key one at a time, then times find().
+template <class Dict>
+timings run_ordered(const vector<string> &keys, const vector<KeyState*> &present,
+                    const vector<KeyState*> &absent) {
+  timings t;
+  ostringstream sink;
+  streambuf *saved = cout.rdbuf(sink.rdbuf());
+  {
+    Dict dict;
+    bench_clock::time_point start = bench_clock::now();
+    for (size_t i=0; i<keys.size(); i++) dict.add(new KeyState(keys[i]), NULL);
+    chrono::duration<double, nano> elapsed = bench_clock::now() - start;
+    t.add = elapsed.count() / (double)keys.size();
+    time_finds(dict, present, absent, t);
+  }
+  cout.rdbuf(saved);
+  t.capacity = (int)keys.size();
+  return t;
+}
+
+// The same, but building the tree with one bulk_load().
+timings run_bulk(const vector<string> &keys, const vector<KeyState*> &present,
+                 const vector<KeyState*> &absent) {
+  timings t;
+  ostringstream sink;
+  streambuf *saved = cout.rdbuf(sink.rdbuf());
+  {
+    BTreeDict dict;
+    size_t n = keys.size();
+    bench_clock::time_point start = bench_clock::now();
+    vector<PuzzleState*> states(n), preds(n, (PuzzleState*)NULL);
+    for (size_t i=0; i<n; i++) states[i] = new KeyState(keys[i]);
+    dict.bulk_load(states, preds);
+    chrono::duration<double, nano> elapsed = bench_clock::now() - start;
+    t.add = elapsed.count() / (double)n;
+    time_finds(dict, present, absent, t);
+  }
+  cout.rdbuf(saved);
+  t.capacity = (int)keys.size();
+  return t;
+}
+
+// Nanoseconds per key offered to find_or_add_batch(), for batches of
+// 1, 2, 4, ... 64 keys, on a dictionary holding every key.  Every
+// offer is a key the dictionary has, as most states a search makes
+// have been seen before.
+template <class Dict>
+vector<double> run_batches(const vector<string> &keys, const vector<string> &offers) {
+  vector<double> ns;
+  ostringstream sink;
+  streambuf *saved = cout.rdbuf(sink.rdbuf());
+  {
+    Dict dict;
+    for (size_t i=0; i<keys.size(); i++) dict.add(new KeyState(keys[i]), NULL);
+    vector<PuzzleState*> states(offers.size());
+    for (size_t i=0; i<offers.size(); i++) states[i] = new KeyState(offers[i]);
+    vector<PuzzleState*> preds(64, (PuzzleState*)NULL), found_preds(64);
+    bool found[64];
+
+    for (int batch=1; batch<=64; batch*=2) {
+      int lost = 0;
+      bench_clock::time_point start = bench_clock::now();
+      for (size_t i=0; i<states.size(); i+=batch) {
+        int n = (int)min((size_t)batch, states.size()-i);
+        dict.find_or_add_batch(n, &states[i], &preds[0], found, &found_preds[0]);
+        for (int j=0; j<n; j++) lost += !found[j];
+      }
+      chrono::duration<double, nano> elapsed = bench_clock::now() - start;
+      ns.push_back(elapsed.count() / (double)states.size());
+      if (lost != 0) cerr << "dictbench: lost keys!" << endl;
+    }
+    for (size_t i=0; i<states.size(); i++) delete states[i];
+  }
+  cout.rdbuf(saved);
+  return ns;
+}
+
+int main(int argc, char *argv[]) {
+  int min_size = (argc > 1) ? atoi(argv[1]) : 393241;
+  // Enough keys for a 0.9 load on a table one size up from min_size.
+  int n = (int)(2.1 * min_size);
+
+  cout << "Making " << 2*n << " keys..." << endl;
+  vector<string> keys = make_slider_keys(2*n, 4, 4, 221u);
+  vector<KeyState*> present, absent;
+  for (int i=0; i<n; i++) {
+    present.push_back(new KeyState(keys[i]));
+    absent.push_back(new KeyState(keys[n+i]));
+  }
+  keys.resize(n);
+
+  cout << "ns per operation\n";
+  cout << "load\ttable\tbuckets\tadd\tfind hit\tfind miss\n";
+  for (int l=5; l<=9; l++) {
+    double load = l / 10.0;
+    timings lin = run<LinearHashDict>(load, min_size, keys, present, absent);
+    timings dbl = run<DoubleHashDict>(load, min_size, keys, present, absent);
+    cout << load << "\tlinear\t" << lin.capacity << "\t" << lin.add << "\t"
+         << lin.hit << "\t\t" << lin.miss << endl;
+    cout << load << "\tdouble\t" << dbl.capacity << "\t" << dbl.add << "\t"
+         << dbl.hit << "\t\t" << dbl.miss << endl;
+  }
+
+  cout << "\nslowest add() of " << n << " keys, in ms\n";
+  cout << "table\tall at once\tincremental\n";
+  cout << "linear\t" << longest_add<LinearHashDict>(false, keys) << "\t\t"
+       << longest_add<LinearHashDict>(true, keys) << endl;
+  cout << "double\t" << longest_add<DoubleHashDict>(false, keys) << "\t\t"
+       << longest_add<DoubleHashDict>(true, keys) << endl;
+
+  cout << "\nordered dictionaries, " << n << " keys, ns per operation\n";
+  cout << "dict\tadd\tfind hit\tfind miss\n";
+  timings avl = run_ordered<AVLDict>(keys, present, absent);
+  timings btree = run_ordered<BTreeDict>(keys, present, absent);
+  timings bulk = run_bulk(keys, present, absent);
+  cout << "avl\t" << avl.add << "\t" << avl.hit << "\t\t" << avl.miss << endl;
+  cout << "btree\t" << btree.add << "\t" << btree.hit << "\t\t" << btree.miss << endl;
+  cout << "bulk\t" << bulk.add << "\t" << bulk.hit << "\t\t" << bulk.miss << endl;
+
+  // Half the keys, in a random order.
+  vector<string> offers(keys);
+  srand(221u);
+  for (size_t i=offers.size()-1; i>0; i--) swap(offers[i], offers[(size_t)rand() % (i+1)]);
+  offers.resize(n/2);
+  vector<double> lin = run_batches<LinearHashDict>(keys, offers);
+  vector<double> dbl = run_batches<DoubleHashDict>(keys, offers);
+  vector<double> swiss = run_batches<SwissHashDict>(keys, offers);
+  cout << "\nfind_or_add_batch() on " << n << " keys, ns per key offered\n";
+  cout << "batch\tlinear\tdouble\tswiss\n";
+  for (size_t i=0; i<lin.size(); i++) {
+    cout << (1 << i) << "\t" << lin[i] << "\t" << dbl[i] << "\t" << swiss[i] << endl;
+  }
+
+  for (int i=0; i<n; i++) {
+    delete present[i];
+    delete absent[i];
+  }
+  return 0;
+}
@@ -0,0 +1,151 @@
+/*
+  hashquality.cpp: contains 'main' function.
+
+  hashquality [keys]
+      Compares the hash policies in KeyHash.hpp on sets of 'keys' ids
+      (default 200000) shaped like each puzzle's:  4x4 SliderPuzzle
+      boards, MazeRunner squares, RiverCrossing states and Sudoku
+      grids.  For each set and policy it reports
+        - ns to hash one key;
+        - how evenly the keys spread over as many buckets as there
+          are keys, by the top half of the hash (which LinearHashDict
+          uses) and by the bottom half (which DoubleHashDict uses
+          first).  This is chi-square, as (chi2 - df) / sqrt(2 df):  a
+          random function lands within about -3..3, and a big positive
+          number means clumping;
+        - how many probes find() takes in a LinearHashDict and a
+          DoubleHashDict holding the keys, at their default loads:  the
+          mean, the share of finds taking 1, 2, 3, 4 and 5 or more,
+          and the most.
+*/
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "PuzzleState.hpp"
+#include "BenchKeys.hpp"
+#include "KeyHash.hpp"
+#include "LinearHashDict.hpp"
+#include "DoubleHashDict.hpp"
+
+using namespace std;
+
+typedef chrono::steady_clock bench_clock;
+
+const int MAX_PROBES = 20; // as the tables count them
+
+// Nanoseconds per key for Hash::hash.
+template <class Hash>
+double time_hash(const vector<string> &keys) {
+  const int ROUNDS = 5;
+  uint64_t sum = 0;
+  bench_clock::time_point start = bench_clock::now();
+  for (int r=0; r<ROUNDS; r++) {
+    for (size_t i=0; i<keys.size(); i++) sum += Hash::hash(keys[i]);
+  }
+  chrono::duration<double, nano> elapsed = bench_clock::now() - start;
+  if (sum == 1) cout << ""; // so the loop isn't optimized away
+  return elapsed.count() / (double)(ROUNDS * keys.size());
+}
+
+// Chi-square of 32-bit values spread over n buckets the way the tables
+// do it (a multiply, not a mod), normalized as above.
+double chi_square(const vector<uint32_t> &values) {
+  size_t n = values.size();
+  vector<int> counts(n, 0);
+  for (size_t i=0; i<n; i++) counts[((uint64_t)values[i] * n) >> 32]++;
+  double chi2 = 0; // each bucket expects 1
+  for (size_t i=0; i<n; i++) chi2 += (counts[i] - 1.0) * (counts[i] - 1.0);
+  double df = (double)n - 1;
+  return (chi2 - df) / sqrt(2 * df);
+}
+
+template <class Hash>
+void spread(const vector<string> &keys, double &top, double &bottom) {
+  vector<uint32_t> high, low;
+  for (size_t i=0; i<keys.size(); i++) {
+    uint64_t h = Hash::hash(keys[i]);
+    high.push_back((uint32_t)(h >> 32));
+    low.push_back((uint32_t)h);
+  }
+  top = chi_square(high);
+  bottom = chi_square(low);
+}
+
+// Fills a Dict with the keys, finds each once, and prints the probes
+// those finds took.
+template <class Dict>
+void print_probes(const vector<KeyState*> &present) {
+  vector<int> counts(MAX_PROBES);
+  // The destructor prints its probe statistics; don't.
+  ostringstream sink;
+  streambuf *saved = cout.rdbuf(sink.rdbuf());
+  {
+    Dict dict;
+    for (size_t i=0; i<present.size(); i++) dict.add(new KeyState(present[i]->getUniqId()), NULL);
+    PuzzleState *pred;
+    for (size_t i=0; i<present.size(); i++) dict.find(present[i], pred);
+    for (int i=0; i<MAX_PROBES; i++) counts[i] = dict.probes(i);
+  }
+  cout.rdbuf(saved);
+
+  double total = 0, finds = 0;
+  int most = 0;
+  for (int i=0; i<MAX_PROBES; i++) {
+    total += (double)i * counts[i];
+    finds += counts[i];
+    if (counts[i] > 0) most = i;
+  }
+  cout << "\t" << total / finds;
+  for (int i=1; i<=4; i++) cout << "\t" << 100.0 * counts[i] / finds << "%";
+  double rest = 0;
+  for (int i=5; i<MAX_PROBES; i++) rest += counts[i];
+  cout << "\t" << 100.0 * rest / finds << "%";
+  cout << "\t" << most << (most == MAX_PROBES-1 ? "+" : "") << endl;
+}
+
+template <class Hash>
+void report(const string &set, const string &name, const vector<string> &keys,
+            const vector<KeyState*> &present) {
+  double top, bottom;
+  spread<Hash>(keys, top, bottom);
+  cout << set << "\t" << name << "\t" << time_hash<Hash>(keys) << "\t"
+       << top << "\t" << bottom << endl;
+  cout << "\t\tlinear";
+  print_probes< BasicLinearHashDict<Hash> >(present);
+  cout << "\t\tdouble";
+  print_probes< BasicDoubleHashDict<Hash> >(present);
+}
+
+int main(int argc, char *argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 200000;
+
+  const int SETS = 4;
+  string names[SETS] = {"slider", "maze", "river", "sudoku"};
+  vector<string> sets[SETS];
+  cout << "Making " << SETS << " sets of " << n << " keys..." << endl;
+  sets[0] = make_slider_keys(n, 4, 4, 221u);
+  sets[1] = make_maze_keys(n);
+  sets[2] = make_river_keys(n);
+  sets[3] = make_sudoku_keys(n, 221u);
+
+  cout << fixed << setprecision(2);
+  cout << "keys\thash\tns/key\tchi top\tchi bottom\n";
+  cout << "\t\ttable\tprobes\t1\t2\t3\t4\t5+\tmost\n";
+  for (int s=0; s<SETS; s++) {
+    vector<KeyState*> present;
+    for (int i=0; i<n; i++) present.push_back(new KeyState(sets[s][i]));
+    report<FNVHash>(names[s], "fnv", sets[s], present);
+    report<PolyHash>(names[s], "poly", sets[s], present);
+    report<MixHash>(names[s], "mix", sets[s], present);
+    report<CRCHash>(names[s], "crc", sets[s], present);
+    for (int i=0; i<n; i++) delete present[i];
+  }
+  return 0;
+}
@@ -0,0 +1,36 @@
+/*
+  mapinspect.cpp: contains 'main' function.
+
+  mapinspect <table file>
+      Checks a MappedHashDict's file, and prints its header, how many
+      keys it holds, how many of them sit outside their home page, and
+      how full its pages are.
+  mapinspect <table file> -list
+      Same, and every key too:  its number, its predecessor's number
+      and its keyID.
+  mapinspect <table file> -trace <number>
+      Prints the keyIDs from state 'number' back to the start.
+*/
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+#include "MappedHashDict.hpp"
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    cerr << "usage:  mapinspect <table file> [-list | -trace <number>]\n";
+    return 2;
+  }
+  bool ok;
+  if (argc > 3 && strcmp(argv[2], "-trace")==0) {
+    ok = MappedHashDict::trace(argv[1], (uint32_t)strtoul(argv[3], NULL, 10), cout);
+  } else {
+    ok = MappedHashDict::inspect(argv[1], cout, argc > 2 && strcmp(argv[2], "-list")==0);
+  }
+  if (!ok) cerr << argv[1] << ":  not a readable table file\n";
+  return ok ? 0 : 1;
+}
@@ -7,6 +7,7 @@
 
 #include <cstring>
 #include <cstdlib>
+#include <memory>
 #include <unistd.h>
 
 // 221 STUDENTS: You'll need to include any .hpp files of classes that
@@ -26,8 +27,15 @@
 
 #include "LinkedListDict.hpp"
 #include "AVLDict.hpp"
+#include "BTreeDict.hpp"
+#include "AdaptiveDict.hpp"
+#include "MappedHashDict.hpp"
 #include "LinearHashDict.hpp"
 #include "DoubleHashDict.hpp"
+#include "SwissHashDict.hpp"
+#include "CuckooHashDict.hpp"
+#include "ConcurrentHashDict.hpp"
+#include "ShardedDict.hpp"
 
 using namespace std;
 
@@ -37,6 +45,11 @@ void solvePuzzle(PuzzleState *start, BagOfPuzzleStates &active, PredDict &seen,
 
   PuzzleState *state;
   PuzzleState *temp;
+  // find_or_add_batch()'s arguments and results, for each expansion.
+  // (vector<bool> has no array to pass, hence the unique_ptr.)
+  vector<PuzzleState*> preds, foundPreds;
+  unique_ptr<bool[]> found;
+  int foundRoom = 0;
 
   active.add(start); // Must explore the successors of the start state.
   seen.add(start,NULL); // We've seen this state.  It has no predecessor.
@@ -75,11 +88,22 @@ void solvePuzzle(PuzzleState *start, BagOfPuzzleStates &active, PredDict &seen,
     }
 
     vector<PuzzleState*> nextMoves = state->getSuccessors();
-    for (unsigned int i=0; i < nextMoves.size(); i++) {
-      if (!seen.find(nextMoves[i], temp)) {
-        // Never seen this state before.  Add it to 'seen' and 'active'
+    // Look the successors up together, so the dictionary can fetch
+    // them from memory all at once.
+    int n = (int)nextMoves.size();
+    if (n==0) continue;
+    preds.assign(n, state);
+    if (n > foundRoom) {
+      found.reset(new bool[n]);
+      foundRoom = n;
+    }
+    foundPreds.resize(n);
+    seen.find_or_add_batch(n, &nextMoves[0], &preds[0], found.get(), &foundPreds[0]);
+    for (int i=0; i < n; i++) {
+      if (!found[i]) {
+        // Never seen this state before.  It's now in 'seen'; add it
+        // to 'active' too.
         active.add(nextMoves[i]);
-        seen.add(nextMoves[i], state);
       } else {
 	delete nextMoves[i];
       }
@@ -148,8 +172,15 @@ int main ()
   // I've provided you an optimized version of LinkedListDict from Project 1.
   LinkedListDict seenStates;
   //AVLDict seenStates;
+  //BTreeDict seenStates;
+  //AdaptiveDict seenStates;
+  //MappedHashDict seenStates("seen.map"); // left behind for mapinspect
   //LinearHashDict seenStates;
   //DoubleHashDict seenStates;
+  //SwissHashDict seenStates;
+  //CuckooHashDict seenStates;
+  //ConcurrentHashDict seenStates;
+  //ShardedDict<LinearHashDict> seenStates;
 
   vector<PuzzleState*> solution;
 